@@ -8,31 +8,43 @@
 #include <exception> // std::out_of_range
 #include <format>
 
+#include "page_allocation.hpp"
+
 template <typename T, std::size_t alignment_bytes>
-concept ValidByteAlignment = (sizeof(T) <= alignment_bytes &&
+concept ValidByteAlignment = (alignof(T) <= alignment_bytes &&
                               alignment_bytes > 0 &&
                               (alignment_bytes & (alignment_bytes - 1)) == 0);
 
+/// @brief Elements are moved around with memcpy, so any trivially copyable type will do:
+/// numbers, frames of several channels or timestamped sensor records
 template <typename T, std::size_t alignment_bytes = 16>
-    requires(std::is_arithmetic_v<T> && ValidByteAlignment<T, alignment_bytes>)
+    requires(std::is_trivially_copyable_v<T> && ValidByteAlignment<T, alignment_bytes>)
 class aligned_array
 {
     std::size_t count;
     T *ptr;
+    page_options options;
+    page_allocation pages;
 
 public:
     aligned_array() : count(0), ptr(nullptr) {};
-    aligned_array(std::size_t num_elements)
-        : count(num_elements), ptr(allocate(num_elements)) {};
+    aligned_array(std::size_t num_elements, const page_options &page_opts = {})
+        : count(num_elements), ptr(nullptr), options(page_opts)
+    {
+        ptr = allocate(num_elements);
+    };
 
     aligned_array(const aligned_array &other)
-        : count(other.count), ptr(allocate(other.count))
+        : count(other.count), ptr(nullptr), options(other.options)
     {
+        ptr = allocate(other.count);
         std::memcpy(ptr, other.ptr, count * sizeof(T));
     }
 
     aligned_array(aligned_array &&other) : count(std::exchange(other.count, 0)),
-                                           ptr(std::exchange(other.ptr, nullptr))
+                                           ptr(std::exchange(other.ptr, nullptr)),
+                                           options(other.options),
+                                           pages(std::exchange(other.pages, {}))
     {
     }
 
@@ -45,12 +57,15 @@ public:
 
         if (count != other.count)
         {
-            operator delete[](ptr, alignment_bytes);
+            page_memory::deallocate(pages, alignment_bytes);
+            pages = {};
             count = other.count;
+            options = other.options;
             ptr = allocate(count);
         }
 
         std::memcpy(ptr, other.ptr, count * sizeof(T));
+        return *this;
     }
 
     aligned_array &operator=(aligned_array &&other)
@@ -61,11 +76,14 @@ public:
         }
         std::swap(count, other.count);
         std::swap(ptr, other.ptr);
+        std::swap(options, other.options);
+        std::swap(pages, other.pages);
+        return *this;
     }
 
     ~aligned_array()
     {
-        operator delete[](ptr, std::align_val_t{alignment_bytes}); // nullptr is a valid input for delete []
+        page_memory::deallocate(pages, alignment_bytes); // nullptr is a valid input
     }
 
     [[nodiscard]] auto size() const noexcept -> std::size_t { return count; }
@@ -79,10 +97,17 @@ public:
         throw std::out_of_range(std::format("offset ({}) exceeds valid range [0 .. {}]", d, count - 1));
     }
 
+    /// @brief offset() without the range check, for hot paths whose offsets are correct by construction
+    [[nodiscard]] auto unchecked_offset(std::size_t d) const noexcept -> T * { return ptr + d; }
+
+    /// @brief Page backend actually in use, which may differ from the requested one after a fallback
+    [[nodiscard]] auto backend() const noexcept -> page_backend { return pages.backend; }
+
 private:
-    [[nodiscard]] T *allocate(std::size_t num_elements) const
+    [[nodiscard]] T *allocate(std::size_t num_elements)
     {
-        return new (std::align_val_t{alignment_bytes}) T[num_elements];
+        pages = page_memory::allocate(num_elements * sizeof(T), alignment_bytes, options);
+        return static_cast<T *>(pages.ptr);
     }
 };
 
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define PC_HAS_SIMD_COPY 1
+#endif
+
+#if defined(__SANITIZE_THREAD__)
+#define PC_THREAD_SANITIZER 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define PC_THREAD_SANITIZER 1
+#endif
+#endif
+
+/// Copy policies used by the SeqLock to move a block between the ring and a private buffer.
+/// `store` copies into the ring (writer), `load` copies out of the ring (readers).
+/// `write_fence` is issued after the sequence is made odd and before the payload is stored,
+/// `read_fence` after the payload is loaded and before the sequence is checked again.
+
+/// @brief Plain std::memcpy. Fast, but the payload accesses race with the writer and are UB
+struct memcpy_copy
+{
+    template <typename T>
+    static void store(T *dst, const T *src, std::size_t count) noexcept
+    {
+        std::memcpy(dst, src, count * sizeof(T));
+    }
+
+    template <typename T>
+    static void load(T *dst, const T *src, std::size_t count) noexcept
+    {
+        std::memcpy(dst, src, count * sizeof(T));
+    }
+
+    static void write_fence() noexcept { std::atomic_signal_fence(std::memory_order_acq_rel); }
+    static void read_fence() noexcept { std::atomic_signal_fence(std::memory_order_acq_rel); }
+};
+
+/// @brief Element by element relaxed atomic copy through std::atomic_ref. Together with the
+/// release/acquire fences this is the data race free SeqLock described by H.-J. Boehm
+struct atomic_copy
+{
+    template <typename T>
+    static void store(T *dst, const T *src, std::size_t count) noexcept
+    {
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            std::atomic_ref<T>(dst[k]).store(src[k], std::memory_order_relaxed);
+        }
+    }
+
+    template <typename T>
+    static void load(T *dst, const T *src, std::size_t count) noexcept
+    {
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            dst[k] = std::atomic_ref<T>(const_cast<T &>(src[k])).load(std::memory_order_relaxed);
+        }
+    }
+
+    static void write_fence() noexcept { std::atomic_thread_fence(std::memory_order_release); }
+    static void read_fence() noexcept { std::atomic_thread_fence(std::memory_order_acquire); }
+};
+
+/// @brief atomic_copy for small blocks, aligned SSE2/AVX2 vector copies for blocks of at least
+/// `threshold_bytes`. Aligned vector accesses are never torn below 8 bytes on x86, which is all
+/// the SeqLock needs since torn blocks are discarded. They are outside the C++ memory model, so
+/// builds with the thread sanitizer always take the atomic path
+template <std::size_t threshold_bytes = 1024>
+struct simd_atomic_copy
+{
+#if defined(__AVX2__)
+    static constexpr std::size_t vector_bytes = 32;
+#else
+    static constexpr std::size_t vector_bytes = 16;
+#endif
+
+    template <typename T>
+    static void store(T *dst, const T *src, std::size_t count) noexcept
+    {
+        if (vectorise(dst, count * sizeof(T)))
+        {
+            vector_copy(dst, src, count * sizeof(T));
+            return;
+        }
+        atomic_copy::store(dst, src, count);
+    }
+
+    template <typename T>
+    static void load(T *dst, const T *src, std::size_t count) noexcept
+    {
+        if (vectorise(src, count * sizeof(T)))
+        {
+            vector_copy(dst, src, count * sizeof(T));
+            return;
+        }
+        atomic_copy::load(dst, src, count);
+    }
+
+    static void write_fence() noexcept { atomic_copy::write_fence(); }
+    static void read_fence() noexcept { atomic_copy::read_fence(); }
+
+private:
+    /// @param shared pointer into the ring, the only side other threads access concurrently
+    [[nodiscard]] static bool vectorise([[maybe_unused]] const void *shared, [[maybe_unused]] std::size_t bytes) noexcept
+    {
+#if defined(PC_HAS_SIMD_COPY) && !defined(PC_THREAD_SANITIZER)
+        return bytes >= threshold_bytes &&
+               bytes % vector_bytes == 0 &&
+               reinterpret_cast<std::uintptr_t>(shared) % vector_bytes == 0;
+#else
+        return false;
+#endif
+    }
+
+    static void vector_copy([[maybe_unused]] void *dst, [[maybe_unused]] const void *src, [[maybe_unused]] std::size_t bytes) noexcept
+    {
+#if defined(PC_HAS_SIMD_COPY) && !defined(PC_THREAD_SANITIZER)
+#if defined(__AVX2__)
+        auto *d = static_cast<__m256i *>(dst);
+        const auto *s = static_cast<const __m256i *>(src);
+        for (std::size_t k = 0; k < bytes / vector_bytes; ++k)
+        {
+            _mm256_storeu_si256(d + k, _mm256_loadu_si256(s + k));
+        }
+#else
+        auto *d = static_cast<__m128i *>(dst);
+        const auto *s = static_cast<const __m128i *>(src);
+        for (std::size_t k = 0; k < bytes / vector_bytes; ++k)
+        {
+            _mm_storeu_si128(d + k, _mm_loadu_si128(s + k));
+        }
+#endif
+#endif
+    }
+};
+
+/// @brief std::memcpy for small blocks, non-temporal (streaming) stores into the ring for blocks of
+/// at least `threshold_bytes`. Streamed lines bypass the writer's caches instead of evicting its
+/// working set, the readers on other cores fetch them from memory or the L3 anyway. Streaming
+/// stores are weakly ordered, so an sfence before them keeps them behind the odd sequence and one
+/// after them makes them visible before the sequence is released. With `prefetch_next` readers
+/// that know their next block pass it to load() and it is prefetched after the copy. Like
+/// memcpy_copy the payload races with the writer; builds with the thread sanitizer never stream
+template <std::size_t threshold_bytes = 32768, bool prefetch_next = false>
+struct streaming_copy
+{
+    static constexpr std::size_t vector_bytes = 16; // the write combining buffers merge them into whole lines
+    static constexpr std::size_t line_bytes = 64;
+
+    template <typename T>
+    static void store(T *dst, const T *src, std::size_t count) noexcept
+    {
+        if (stream(dst, count * sizeof(T)))
+        {
+            stream_copy(dst, src, count * sizeof(T));
+            return;
+        }
+        std::memcpy(dst, src, count * sizeof(T));
+    }
+
+    template <typename T>
+    static void load(T *dst, const T *src, std::size_t count) noexcept
+    {
+        std::memcpy(dst, src, count * sizeof(T));
+    }
+
+    /// @brief Copy like load() and prefetch `count` elements at `next`, the block the reader will
+    /// read after this one. The caller wraps `next` around the end of the ring
+    template <typename T>
+    static void load(T *dst, const T *src, std::size_t count, [[maybe_unused]] const T *next) noexcept
+    {
+        std::memcpy(dst, src, count * sizeof(T));
+        if constexpr (prefetch_next)
+        {
+            prefetch(next, count * sizeof(T));
+        }
+    }
+
+    static void write_fence() noexcept { memcpy_copy::write_fence(); }
+    static void read_fence() noexcept { memcpy_copy::read_fence(); }
+
+    [[nodiscard]] static bool stream([[maybe_unused]] const void *shared, [[maybe_unused]] std::size_t bytes) noexcept
+    {
+#if defined(PC_HAS_SIMD_COPY) && !defined(PC_THREAD_SANITIZER)
+        return bytes >= threshold_bytes &&
+               bytes % vector_bytes == 0 &&
+               reinterpret_cast<std::uintptr_t>(shared) % vector_bytes == 0;
+#else
+        return false;
+#endif
+    }
+
+private:
+    static void stream_copy([[maybe_unused]] void *dst, [[maybe_unused]] const void *src, [[maybe_unused]] std::size_t bytes) noexcept
+    {
+#if defined(PC_HAS_SIMD_COPY) && !defined(PC_THREAD_SANITIZER)
+        auto *d = static_cast<__m128i *>(dst);
+        const auto *s = static_cast<const __m128i *>(src);
+        _mm_sfence();
+        for (std::size_t k = 0; k < bytes / vector_bytes; ++k)
+        {
+            _mm_stream_si128(d + k, _mm_loadu_si128(s + k));
+        }
+        _mm_sfence();
+#endif
+    }
+
+    static void prefetch([[maybe_unused]] const void *next, [[maybe_unused]] std::size_t bytes) noexcept
+    {
+#if defined(PC_HAS_SIMD_COPY)
+        const char *p = static_cast<const char *>(next);
+        for (std::size_t k = 0; k < bytes; k += line_bytes)
+        {
+            _mm_prefetch(p + k, _MM_HINT_T0);
+        }
+#elif defined(__GNUC__)
+        const char *p = static_cast<const char *>(next);
+        for (std::size_t k = 0; k < bytes; k += line_bytes)
+        {
+            __builtin_prefetch(p + k, 0, 3);
+        }
+#endif
+    }
+};
@@ -1,100 +1,483 @@
 #pragma once
 
 #include "aligned_array.hpp"
+#include "consumer.hpp"
+#include "latency_histogram.hpp"
+#include "perf_counters.hpp"
+#include "timer.hpp"
+#include "topology.hpp"
+#include "wait_strategy.hpp"
+#include <atomic>
 #include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
 #include <chrono>
 #include <latch>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// @brief What a reader does with each block
+enum class read_mode
+{
+    copy,        // copy the block into a local buffer
+    copy_reduce, // copy the block into a local buffer and reduce the copy
+    view_reduce  // reduce the block in place through solution::read_view, retrying on conflicts
+};
+
+/// @brief Mean time per operation for the writer (first element) followed by the readers.
+/// Readers following the writer's sequence also report the number of blocks they lost.
+/// Benchmarks that time every operation also fill the latency histograms, the read histogram
+/// merges all readers. Throughput benchmarks report how far behind the writer each reader was on
+/// average in `lag`, in blocks. Benchmarks may attach further named figures in `metrics` and descriptions in `labels`
+struct benchmark_results
+{
+    std::vector<double> times;
+    std::vector<std::size_t> lost;
+    std::vector<double> lag;
+    std::vector<std::pair<std::string, double>> metrics;
+    std::vector<std::pair<std::string, std::string>> labels;
+    latency_histogram write_latency;
+    latency_histogram read_latency;
+};
+
+/// @brief Pin the writer and reader threads to the CPUs chosen for `policy` and record the placement
+/// in the results. Threads that cannot be pinned run wherever the scheduler puts them
+inline void place_threads(placement policy,
+                          std::span<std::thread> writer_threads,
+                          std::span<std::thread> reader_threads,
+                          benchmark_results &results)
+{
+    const cpu_topology &topology = cpu_topology::system();
+    if (policy == placement::cross_l3 && topology.l3_domains() < 2)
+    {
+        spdlog::warn("Placement cross-l3 needs more than one L3 domain, the threads are scattered instead");
+    }
+    const std::vector<int> cpus = topology.assign(policy, writer_threads.size() + reader_threads.size());
+    bool pinned = true;
+    for (std::size_t k = 0; k < writer_threads.size(); ++k)
+    {
+        pinned = pin_thread(writer_threads[k], cpus[k]) && pinned;
+    }
+    for (std::size_t k = 0; k < reader_threads.size(); ++k)
+    {
+        pinned = pin_thread(reader_threads[k], cpus[writer_threads.size() + k]) && pinned;
+    }
+    if (!pinned)
+    {
+        spdlog::warn("Placement {} could not pin every thread", to_string(policy));
+    }
+    results.labels.emplace_back("placement", pinned ? to_string(policy) : to_string(placement::none));
+    results.labels.emplace_back("cpus", pinned ? cpu_list(cpus) : cpu_list(std::vector<int>(cpus.size(), -1)));
+}
+
+/// @brief Solutions that can move several consecutive blocks in one operation
+template <typename solution, typename data_type>
+concept batch_solution = requires(solution &store, data_type *p, std::size_t n) {
+    store.write_batch(p, n);
+    store.read_batch(p, n, n);
+};
+
+/// @brief Solutions that accept writes from several producer threads at once
+template <typename solution>
+concept multi_producer_solution = requires { requires solution::multi_producer; };
+
+template <typename solution, typename data_type>
+void write_blocks(solution &store, const data_type *src, std::size_t block_size, std::size_t batch)
+{
+    if constexpr (batch_solution<solution, data_type>)
+    {
+        if (batch > 1)
+        {
+            store.write_batch(src, block_size * batch);
+            return;
+        }
+    }
+    store.write(src, block_size);
+}
+
+template <typename solution, typename data_type>
+void read_blocks(solution &store, data_type *dst, std::size_t block_size, std::size_t batch, std::size_t offset)
+{
+    if constexpr (batch_solution<solution, data_type>)
+    {
+        if (batch > 1)
+        {
+            store.read_batch(dst, block_size * batch, offset);
+            return;
+        }
+    }
+    store.read(dst, block_size, offset);
+}
+
+/// Writers and readers move `batch` blocks per operation and report the mean time per block.
+/// With `sample_every` = N only one operation in N is timed and recorded
 
 template <typename solution, typename data_type, std::size_t alignment_bytes>
 void writer(solution &store,
             std::size_t block_size,
             std::size_t cycles,
+            std::size_t batch,
+            std::size_t sample_every,
             std::latch &thread_latch,
-            double &write_time_ns)
+            double &write_time_ns,
+            latency_histogram &histogram,
+            perf_counts &counters)
 {
     spdlog::info("writer starts");
 
     data_type value{0};
-    aligned_array<data_type, alignment_bytes> src(block_size);
+    aligned_array<data_type, alignment_bytes> src(block_size * batch);
 
     fill_array(src, value++);
-    store.write(src.data(), block_size);
+    write_blocks(store, src.data(), block_size, batch);
+    perf_counters perf;
 
     thread_latch.arrive_and_wait();
 
+    benchmark_timer timer(sample_every);
     write_time_ns = 0;
-    for (size_t k = 1; k < cycles; ++k)
+    perf.start();
+    std::size_t timed{0};
+    const std::size_t operations = cycles / batch;
+    for (size_t k = 1; k < operations; ++k)
     {
         fill_array(src, value++);
-        const auto t0 = std::chrono::high_resolution_clock::now();
-        store.write(src.data(), block_size);
-        const auto dt = std::chrono::high_resolution_clock::now() - t0;
-        write_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count();
+        if (timer.sample())
+        {
+            const std::uint64_t t0 = timer.start();
+            write_blocks(store, src.data(), block_size, batch);
+            const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+            write_time_ns += static_cast<double>(ns);
+            histogram.record(ns);
+            ++timed;
+        }
+        else
+        {
+            write_blocks(store, src.data(), block_size, batch);
+        }
     }
+    perf.stop();
+    counters = perf.read();
 
-    write_time_ns = write_time_ns / (cycles - 1);
+    write_time_ns = timed > 0 ? write_time_ns / (timed * batch) : 0.0;
     spdlog::info("Writer terminates. Write time, ns: {:.1f}", write_time_ns);
 }
 
-template <typename solution, typename data_type, std::size_t alignment_bytes>
+template <typename solution, typename data_type, std::size_t alignment_bytes, read_mode mode = read_mode::copy>
 void reader(solution &store,
             std::size_t block_size,
             std::size_t cycles,
+            std::size_t batch,
             std::size_t index,
+            std::size_t sample_every,
             std::latch &thread_latch,
-            double &read_time_ns)
+            double &read_time_ns,
+            latency_histogram &histogram,
+            perf_counts &counters)
 {
     spdlog::info("Reader {} starts", index);
 
-    aligned_array<data_type, alignment_bytes> dst(block_size);
+    aligned_array<data_type, alignment_bytes> dst(block_size * batch);
+    benchmark_timer timer(sample_every);
+    perf_counters perf;
     thread_latch.arrive_and_wait();
     read_time_ns = 0;
+    std::size_t timed{0};
     std::size_t offset{0};
     const std::size_t total_size = store.size();
+    data_type checksum{0};
+    const auto sum_of = [](std::span<const data_type> block)
+    {
+        return std::accumulate(block.begin(), block.end(), data_type{0});
+    };
 
-    for (size_t k = 0; k < cycles; ++k)
+    const auto read_once = [&]
     {
-        const auto t0 = std::chrono::high_resolution_clock::now();
-        store.read(dst.data(), block_size, offset);
-        const auto dt = std::chrono::high_resolution_clock::now() - t0;
-        offset += block_size;
+        if constexpr (mode == read_mode::view_reduce)
+        {
+            data_type sum{0};
+            while (!store.read_view(offset, [&sum, &sum_of](std::span<const data_type> block)
+                                    { sum = sum_of(block); }))
+            {
+            }
+            checksum += sum;
+        }
+        else
+        {
+            read_blocks(store, dst.data(), block_size, batch, offset);
+            if constexpr (mode == read_mode::copy_reduce)
+            {
+                checksum += sum_of(std::span<const data_type>(dst.data(), block_size * batch));
+            }
+        }
+    };
+
+    const std::size_t operations = cycles / batch;
+    perf.start();
+    for (size_t k = 0; k < operations; ++k)
+    {
+        if (timer.sample())
+        {
+            const std::uint64_t t0 = timer.start();
+            read_once();
+            const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+            read_time_ns += static_cast<double>(ns);
+            histogram.record(ns);
+            ++timed;
+        }
+        else
+        {
+            read_once();
+        }
+        offset += block_size * batch;
         offset = offset % total_size;
-        read_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count();
     }
+    perf.stop();
+    counters = perf.read();
 
-    read_time_ns = read_time_ns / cycles;
-    spdlog::info("Reader {} terminates. Read time, ns: {:.1f}", index, read_time_ns);
+    read_time_ns = timed > 0 ? read_time_ns / (timed * batch) : 0.0;
+    spdlog::info("Reader {} terminates. Read time, ns: {:.1f}, checksum: {}", index, read_time_ns, checksum);
 }
 
 template <typename solution, typename data_type, std::size_t alignment_bytes>
-std::vector<double> run_benchmark(std::size_t num_blocks,
+void sequenced_reader(solution &store,
+                      std::size_t block_size,
+                      std::size_t cycles,
+                      std::size_t index,
+                      std::size_t sample_every,
+                      std::latch &thread_latch,
+                      double &read_time_ns,
+                      std::size_t &lost_blocks,
+                      latency_histogram &histogram,
+                      perf_counts &counters)
+{
+    spdlog::info("Sequenced reader {} starts", index);
+
+    aligned_array<data_type, alignment_bytes> dst(block_size);
+    consumer_cursor consumer;
+    benchmark_timer timer(sample_every);
+    perf_counters perf;
+    thread_latch.arrive_and_wait();
+    read_time_ns = 0;
+    std::size_t received{0};
+    std::size_t timed{0};
+    perf.start();
+
+    // the writer publishes exactly `cycles` blocks, every one of them is either read or lost
+    while (consumer.next < cycles)
+    {
+        if (timer.sample())
+        {
+            const std::uint64_t t0 = timer.start();
+            const read_result result = store.read_next(dst.data(), block_size, consumer);
+            const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+            if (result.status == read_status::ok)
+            {
+                read_time_ns += static_cast<double>(ns);
+                histogram.record(ns);
+                ++received;
+                ++timed;
+            }
+        }
+        else if (store.read_next(dst.data(), block_size, consumer).status == read_status::ok)
+        {
+            ++received;
+        }
+    }
+    perf.stop();
+    counters = perf.read();
+
+    read_time_ns = timed > 0 ? read_time_ns / timed : 0.0;
+    lost_blocks = consumer.lost;
+    spdlog::info("Sequenced reader {} terminates. Read time, ns: {:.1f}, received: {}, lost: {}",
+                 index, read_time_ns, received, lost_blocks);
+}
+
+/// @brief Hardware counters per block of the writer and of the average reader, added as metrics
+/// when perf counters are enabled. Events that could not be counted are left out
+inline void add_perf_metrics(benchmark_results &results,
+                             const perf_counts &writer_counts,
+                             const std::vector<perf_counts> &reader_counts,
+                             std::size_t blocks)
+{
+    if (!perf_counters::enabled())
+    {
+        return;
+    }
+    perf_counts readers = reader_counts.empty() ? perf_counts{} : reader_counts.front();
+    for (std::size_t k = 1; k < reader_counts.size(); ++k)
+    {
+        readers.add(reader_counts[k]);
+    }
+    if (!writer_counts.any() && !readers.any())
+    {
+        results.labels.emplace_back("perf_counters", "unavailable");
+        return;
+    }
+    const double per_block = 1.0 / static_cast<double>(std::max<std::size_t>(blocks, 1));
+    for (std::size_t k = 0; k < perf_event_count; ++k)
+    {
+        const char *name = to_string(static_cast<perf_event>(k));
+        if (writer_counts.valid[k])
+        {
+            results.metrics.emplace_back(fmt::format("writer_{}_per_block", name), writer_counts.values[k] * per_block);
+        }
+        if (readers.valid[k])
+        {
+            results.metrics.emplace_back(fmt::format("reader_{}_per_block", name),
+                                         readers.values[k] * per_block / static_cast<double>(reader_counts.size()));
+        }
+    }
+}
+
+template <typename solution, typename data_type, std::size_t alignment_bytes, read_mode mode = read_mode::copy>
+benchmark_results run_benchmark(std::size_t num_blocks,
                                   std::size_t block_size,
                                   std::size_t num_readers,
-                                  std::size_t cycles)
+                                  std::size_t cycles,
+                                  std::size_t batch = 1,
+                                  const page_options &pages = {},
+                                  std::size_t sample_every = 1,
+                                  placement policy = placement::none,
+                                  std::size_t num_writers = 1)
+{
+    if (batch == 0 || batch > num_blocks)
+    {
+        throw std::runtime_error("batch size must be between 1 and the number of blocks");
+    }
+    if (batch > 1 && (mode == read_mode::view_reduce || !batch_solution<solution, data_type>))
+    {
+        throw std::runtime_error("solution or read mode does not support batches");
+    }
+    if (num_writers == 0 || (num_writers > 1 && !multi_producer_solution<solution>))
+    {
+        throw std::runtime_error("solution does not support several producers");
+    }
+
+    solution store(num_blocks, block_size, pages);
+    store.fill(data_type{12345});
+
+    // the last count is released once the threads are placed
+    std::latch thread_latch(static_cast<std::ptrdiff_t>(num_writers + num_readers + 1));
+    benchmark_results results{std::vector<double>(num_readers + 1)};
+    results.labels.emplace_back("page_backend", to_string(store.backend()));
+    results.labels.emplace_back("clock_source", to_string(clock_ticks::calibration().source));
+    std::vector<double> &times = results.times;
+
+    // the producers share the cycles, each one reports its own mean and they are averaged
+    std::vector<double> write_times(num_writers);
+    std::vector<latency_histogram> write_histograms(num_writers);
+    std::vector<perf_counts> writer_counts(num_writers);
+    std::vector<std::thread> writers;
+    for (std::size_t k = 0; k < num_writers; ++k)
+    {
+        writers.emplace_back(writer<solution, data_type, alignment_bytes>,
+                             std::ref(store),
+                             block_size,
+                             cycles / num_writers,
+                             batch,
+                             sample_every,
+                             std::ref(thread_latch),
+                             std::ref(write_times[k]),
+                             std::ref(write_histograms[k]),
+                             std::ref(writer_counts[k]));
+    }
+
+    std::vector<latency_histogram> histograms(num_readers);
+    std::vector<perf_counts> reader_counts(num_readers);
+    std::vector<std::thread> readers;
+    for (std::size_t k = 0; k < num_readers; ++k)
+    {
+        readers.emplace_back(reader<solution, data_type, alignment_bytes, mode>,
+                             std::ref(store),
+                             block_size,
+                             cycles,
+                             batch,
+                             k,
+                             sample_every,
+                             std::ref(thread_latch),
+                             std::ref(times[k + 1]),
+                             std::ref(histograms[k]),
+                             std::ref(reader_counts[k]));
+    }
+
+    place_threads(policy, writers, readers, results);
+    thread_latch.count_down();
+
+    for (auto &w : writers)
+    {
+        w.join();
+    }
+    for (auto &r : readers)
+    {
+        r.join();
+    }
+    perf_counts all_writers = writer_counts.front();
+    for (std::size_t k = 0; k < num_writers; ++k)
+    {
+        times[0] += write_times[k] / static_cast<double>(num_writers);
+        results.write_latency.merge(write_histograms[k]);
+        if (k > 0)
+        {
+            all_writers.add(writer_counts[k]);
+        }
+    }
+    for (const auto &h : histograms)
+    {
+        results.read_latency.merge(h);
+    }
+    add_perf_metrics(results, all_writers, reader_counts, cycles);
+
+    return results;
+}
+
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+benchmark_results run_sequenced_benchmark(std::size_t num_blocks,
+                                          std::size_t block_size,
+                                          std::size_t num_readers,
+                                          std::size_t cycles,
+                                          std::size_t sample_every = 1)
 {
     solution store(num_blocks, block_size);
     store.fill(data_type{12345});
 
     std::latch thread_latch(num_readers + 1);
-    std::vector<double> times(num_readers + 1);
+    benchmark_results results{std::vector<double>(num_readers + 1), std::vector<std::size_t>(num_readers)};
+    results.labels.emplace_back("clock_source", to_string(clock_ticks::calibration().source));
+    std::vector<double> &times = results.times;
+    perf_counts writer_counts;
 
     std::thread writer_thread(writer<solution, data_type, alignment_bytes>,
                               std::ref(store),
                               block_size,
                               cycles,
+                              std::size_t{1},
+                              sample_every,
                               std::ref(thread_latch),
-                              std::ref(times[0]));
+                              std::ref(times[0]),
+                              std::ref(results.write_latency),
+                              std::ref(writer_counts));
 
+    std::vector<latency_histogram> histograms(num_readers);
+    std::vector<perf_counts> reader_counts(num_readers);
     std::vector<std::thread> readers;
     for (std::size_t k = 0; k < num_readers; ++k)
     {
-        readers.emplace_back(reader<solution, data_type, alignment_bytes>,
+        readers.emplace_back(sequenced_reader<solution, data_type, alignment_bytes>,
                              std::ref(store),
                              block_size,
                              cycles,
                              k,
+                             sample_every,
                              std::ref(thread_latch),
-                             std::ref(times[k + 1]));
+                             std::ref(times[k + 1]),
+                             std::ref(results.lost[k]),
+                             std::ref(histograms[k]),
+                             std::ref(reader_counts[k]));
     }
 
     writer_thread.join();
@@ -102,6 +485,200 @@ std::vector<double> run_benchmark(std::size_t num_blocks,
     {
         r.join();
     }
+    for (const auto &h : histograms)
+    {
+        results.read_latency.merge(h);
+    }
+    add_perf_metrics(results, writer_counts, reader_counts, cycles);
+
+    return results;
+}
+/// @brief Counter of blocks written or consumed, on its own cache line
+struct alignas(128) progress_counter
+{
+    std::atomic<std::size_t> value{0};
+};
+
+/// @brief Spin briefly, then yield, while waiting for the other side in the throughput benchmark
+inline void back_off(std::size_t &spins) noexcept
+{
+    if (spins++ < 256)
+    {
+        cpu_relax();
+    }
+    else
+    {
+        std::this_thread::yield();
+    }
+}
+
+/// @brief Write as fast as the slowest reader allows until `duration` has passed: block n is only
+/// written once every reader has consumed block n - num_blocks, so nothing is ever lost
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void throughput_writer(solution &store,
+                       std::size_t num_blocks,
+                       std::size_t block_size,
+                       std::chrono::nanoseconds duration,
+                       progress_counter &written,
+                       std::vector<progress_counter> &consumed,
+                       std::atomic<bool> &stopped,
+                       std::latch &thread_latch,
+                       double &elapsed_ns)
+{
+    spdlog::info("Throughput writer starts");
+
+    data_type value{0};
+    aligned_array<data_type, alignment_bytes> src(block_size);
+    const auto slowest = [&consumed]
+    {
+        std::size_t m = ~std::size_t{0};
+        for (const auto &c : consumed)
+        {
+            m = std::min(m, c.value.load(std::memory_order_acquire));
+        }
+        return m;
+    };
+
+    thread_latch.arrive_and_wait();
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto deadline = t0 + duration;
+    std::size_t n{0};
+    std::size_t oldest = slowest();
+    while ((n % 64 != 0) || std::chrono::steady_clock::now() < deadline)
+    {
+        for (std::size_t spins = 0; n - oldest >= num_blocks; oldest = slowest())
+        {
+            back_off(spins);
+        }
+        fill_array(src, value++);
+        store.write(src.data(), block_size);
+        written.value.store(++n, std::memory_order_release);
+    }
+    elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count());
+    stopped.store(true, std::memory_order_release);
+    spdlog::info("Throughput writer terminates. Blocks written: {}", n);
+}
+
+/// @brief Consume every block in order, recording how many blocks behind the writer it was at each read
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void throughput_reader(solution &store,
+                       std::size_t num_blocks,
+                       std::size_t block_size,
+                       std::size_t index,
+                       const progress_counter &written,
+                       progress_counter &consumed,
+                       const std::atomic<bool> &stopped,
+                       std::latch &thread_latch,
+                       double &elapsed_ns,
+                       double &mean_lag)
+{
+    spdlog::info("Throughput reader {} starts", index);
 
-    return times;
-}
\ No newline at end of file
+    aligned_array<data_type, alignment_bytes> dst(block_size);
+    thread_latch.arrive_and_wait();
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::size_t n{0};
+    double lag{0};
+    for (std::size_t spins = 0;;)
+    {
+        const std::size_t available = written.value.load(std::memory_order_acquire);
+        if (available == n)
+        {
+            if (stopped.load(std::memory_order_acquire) && written.value.load(std::memory_order_acquire) == n)
+            {
+                break;
+            }
+            back_off(spins);
+            continue;
+        }
+        spins = 0;
+        lag += static_cast<double>(available - n - 1);
+        store.read(dst.data(), block_size, (n % num_blocks) * block_size);
+        consumed.value.store(++n, std::memory_order_release);
+    }
+    elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count());
+    mean_lag = n > 0 ? lag / static_cast<double>(n) : 0.0;
+    spdlog::info("Throughput reader {} terminates. Blocks read: {}, mean lag: {:.1f}", index, n, mean_lag);
+}
+
+/// @brief Attach the sustained rates of a throughput run to `results`
+inline void add_throughput_metrics(benchmark_results &results,
+                                   std::size_t messages,
+                                   std::size_t delivered,
+                                   std::size_t block_bytes,
+                                   double elapsed_ns)
+{
+    const double seconds = std::max(elapsed_ns, 1.0) * 1e-9;
+    results.metrics.emplace_back("duration_s", seconds);
+    results.metrics.emplace_back("messages_per_s", static_cast<double>(messages) / seconds);
+    results.metrics.emplace_back("write_gb_per_s", static_cast<double>(messages * block_bytes) / seconds * 1e-9);
+    results.metrics.emplace_back("delivered_gb_per_s", static_cast<double>(delivered * block_bytes) / seconds * 1e-9);
+}
+
+/// @brief Time-boxed throughput: the writer produces for `duration` as fast as the slowest of the
+/// readers keeps up, every reader consumes every block. Times are ns per block at the sustained rate
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+benchmark_results run_throughput_benchmark(std::size_t num_blocks,
+                                           std::size_t block_size,
+                                           std::size_t num_readers,
+                                           std::chrono::nanoseconds duration)
+{
+    solution store(num_blocks, block_size);
+    store.fill(data_type{12345});
+
+    std::latch thread_latch(num_readers + 1);
+    benchmark_results results{std::vector<double>(num_readers + 1), std::vector<std::size_t>(num_readers), std::vector<double>(num_readers)};
+    std::vector<double> elapsed(num_readers + 1);
+    progress_counter written;
+    std::vector<progress_counter> consumed(num_readers);
+    std::atomic<bool> stopped{false};
+
+    std::thread writer_thread(throughput_writer<solution, data_type, alignment_bytes>,
+                              std::ref(store),
+                              num_blocks,
+                              block_size,
+                              duration,
+                              std::ref(written),
+                              std::ref(consumed),
+                              std::ref(stopped),
+                              std::ref(thread_latch),
+                              std::ref(elapsed[0]));
+
+    std::vector<std::thread> readers;
+    for (std::size_t k = 0; k < num_readers; ++k)
+    {
+        readers.emplace_back(throughput_reader<solution, data_type, alignment_bytes>,
+                             std::ref(store),
+                             num_blocks,
+                             block_size,
+                             k,
+                             std::cref(written),
+                             std::ref(consumed[k]),
+                             std::cref(stopped),
+                             std::ref(thread_latch),
+                             std::ref(elapsed[k + 1]),
+                             std::ref(results.lag[k]));
+    }
+
+    writer_thread.join();
+    for (auto &r : readers)
+    {
+        r.join();
+    }
+
+    const std::size_t messages = written.value.load();
+    std::size_t delivered{0};
+    for (std::size_t k = 0; k < num_readers; ++k)
+    {
+        delivered += consumed[k].value.load();
+        results.lost[k] = messages - consumed[k].value.load();
+    }
+    for (std::size_t k = 0; k <= num_readers; ++k)
+    {
+        results.times[k] = messages > 0 ? elapsed[k] / static_cast<double>(messages) : 0.0;
+    }
+    add_throughput_metrics(results, messages, delivered, block_size * sizeof(data_type), elapsed[0]);
+    return results;
+}
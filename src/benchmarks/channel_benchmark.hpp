@@ -0,0 +1,196 @@
+#pragma once
+
+#include "aligned_array.hpp"
+#include "benchmark.hpp"
+#include "channel_seqlock_solution.hpp"
+#include <spdlog/spdlog.h>
+#include <cstdint>
+#include <latch>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// Multi-channel frames through a SeqLock ring: the writer hands over blocks of interleaved
+/// frames, and every reader consumes a single channel, reader k channel k % channels. The samples
+/// are numbers such as float or int16 audio, or timestamped sensor records
+
+/// @brief Timestamped reading of one sensor, a struct payload of 16 bytes
+struct sensor_sample
+{
+    std::uint64_t timestamp_ns;
+    float value;
+    std::uint32_t status;
+
+    friend bool operator==(const sensor_sample &, const sensor_sample &) = default;
+};
+
+static_assert(std::is_trivially_copyable_v<sensor_sample> && sizeof(sensor_sample) == 16);
+
+/// @brief Sample carrying the number of the block it was written in
+template <typename data_type>
+constexpr auto make_payload(std::size_t k) noexcept -> data_type
+{
+    if constexpr (std::is_arithmetic_v<data_type>)
+    {
+        return static_cast<data_type>(k);
+    }
+    else
+    {
+        return data_type{k, static_cast<float>(k), 0};
+    }
+}
+
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void frame_writer(solution &store,
+                  std::size_t frames,
+                  std::size_t channels,
+                  std::size_t cycles,
+                  std::size_t sample_every,
+                  std::latch &thread_latch,
+                  double &write_time_ns,
+                  latency_histogram &histogram,
+                  perf_counts &counters)
+{
+    spdlog::info("Frame writer starts");
+
+    aligned_array<data_type, alignment_bytes> src(frames * channels);
+    benchmark_timer timer(sample_every);
+    perf_counters perf;
+    thread_latch.arrive_and_wait();
+
+    write_time_ns = 0;
+    std::size_t timed{0};
+    perf.start();
+    for (std::size_t k = 0; k < cycles; ++k)
+    {
+        fill_array(src, make_payload<data_type>(k));
+        if (timer.sample())
+        {
+            const std::uint64_t t0 = timer.start();
+            store.write(src.data(), src.size());
+            const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+            write_time_ns += static_cast<double>(ns);
+            histogram.record(ns);
+            ++timed;
+        }
+        else
+        {
+            store.write(src.data(), src.size());
+        }
+    }
+    perf.stop();
+    counters = perf.read();
+
+    write_time_ns = timed > 0 ? write_time_ns / timed : 0.0;
+    spdlog::info("Frame writer terminates. Write time, ns: {:.1f}", write_time_ns);
+}
+
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void channel_reader(solution &store,
+                    std::size_t frames,
+                    std::size_t cycles,
+                    std::size_t index,
+                    std::size_t sample_every,
+                    std::latch &thread_latch,
+                    double &read_time_ns,
+                    latency_histogram &histogram,
+                    perf_counts &counters)
+{
+    const std::size_t channel = index % store.channels();
+    spdlog::info("Channel reader {} starts on channel {}", index, channel);
+
+    aligned_array<data_type, alignment_bytes> dst(frames);
+    benchmark_timer timer(sample_every);
+    perf_counters perf;
+    thread_latch.arrive_and_wait();
+
+    read_time_ns = 0;
+    std::size_t timed{0};
+    std::size_t offset{0};
+    perf.start();
+    for (std::size_t k = 0; k < cycles; ++k)
+    {
+        if (timer.sample())
+        {
+            const std::uint64_t t0 = timer.start();
+            store.read_channel(dst.data(), frames, offset, channel);
+            const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+            read_time_ns += static_cast<double>(ns);
+            histogram.record(ns);
+            ++timed;
+        }
+        else
+        {
+            store.read_channel(dst.data(), frames, offset, channel);
+        }
+        offset = (offset + store.block_size()) % store.size();
+    }
+    perf.stop();
+    counters = perf.read();
+
+    read_time_ns = timed > 0 ? read_time_ns / timed : 0.0;
+    spdlog::info("Channel reader {} terminates. Read time, ns: {:.1f}", index, read_time_ns);
+}
+
+/// @brief Writer of blocks of `frames` interleaved frames and `num_readers` single-channel readers
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+benchmark_results run_channel_benchmark(std::size_t num_blocks,
+                                      std::size_t frames,
+                                      std::size_t channels,
+                                      std::size_t num_readers,
+                                      std::size_t cycles,
+                                      std::size_t sample_every = 1)
+{
+    solution store(num_blocks, frames, channels);
+    store.fill(make_payload<data_type>(12345));
+
+    std::latch thread_latch(num_readers + 1);
+    benchmark_results results{std::vector<double>(num_readers + 1), std::vector<std::size_t>(num_readers)};
+    results.labels.emplace_back("clock_source", to_string(clock_ticks::calibration().source));
+    results.labels.emplace_back("channels", std::to_string(channels));
+    results.metrics.emplace_back("channel_bytes_per_read", static_cast<double>(frames * sizeof(data_type)));
+    std::vector<double> &times = results.times;
+    perf_counts writer_counts;
+
+    std::thread writer_thread(frame_writer<solution, data_type, alignment_bytes>,
+                              std::ref(store),
+                              frames,
+                              channels,
+                              cycles,
+                              sample_every,
+                              std::ref(thread_latch),
+                              std::ref(times[0]),
+                              std::ref(results.write_latency),
+                              std::ref(writer_counts));
+
+    std::vector<latency_histogram> histograms(num_readers);
+    std::vector<perf_counts> reader_counts(num_readers);
+    std::vector<std::thread> readers;
+    for (std::size_t k = 0; k < num_readers; ++k)
+    {
+        readers.emplace_back(channel_reader<solution, data_type, alignment_bytes>,
+                             std::ref(store),
+                             frames,
+                             cycles,
+                             k,
+                             sample_every,
+                             std::ref(thread_latch),
+                             std::ref(times[k + 1]),
+                             std::ref(histograms[k]),
+                             std::ref(reader_counts[k]));
+    }
+
+    writer_thread.join();
+    for (auto &r : readers)
+    {
+        r.join();
+    }
+    for (const auto &h : histograms)
+    {
+        results.read_latency.merge(h);
+    }
+    add_perf_metrics(results, writer_counts, reader_counts, cycles);
+
+    return results;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "aligned_array.hpp"
+#include "atomic_copy.hpp"
+#include "seqlock_solution.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+/// @brief How a SeqLock ring of multi-channel frames lays out the channels of a block
+enum class channel_layout
+{
+    interleaved, // array of structures: the samples of a frame are next to each other, as an audio interface delivers them
+    planar       // structure of arrays: each channel of a block is contiguous and starts on its own cache line
+};
+
+/// @brief SeqLock ring whose blocks hold `frames` frames of `channels` samples each. The writer
+/// always hands over interleaved frames. The planar layout splits them into channels on the way in,
+/// so a consumer of a single channel copies only that channel's cache lines instead of striding
+/// through every frame. Blocks start on cache lines in both layouts
+template <typename data_type, std::size_t alignment_bytes, channel_layout layout, typename copy_policy = memcpy_copy>
+    requires(64 % sizeof(data_type) == 0)
+class channel_seqlock_solution
+{
+    static constexpr std::size_t cache_line = 64;
+    static constexpr std::size_t line_elements = cache_line / sizeof(data_type);
+
+    std::size_t n_blocks;
+    std::size_t n_frames;
+    std::size_t n_channels;
+    std::size_t plane_elements; // distance between the channels of a planar block
+    std::size_t slot_elements;  // distance between consecutive blocks in the array
+    std::vector<cursor<>> cursors;
+    cursor<> published;
+    std::size_t index_write;
+    aligned_array<data_type, std::max(alignment_bytes, cache_line)> a;
+
+    [[nodiscard]] static auto round_to_lines(std::size_t elements) noexcept -> std::size_t
+    {
+        return (elements + line_elements - 1) / line_elements * line_elements;
+    }
+
+    [[nodiscard]] static auto slot_size(std::size_t frames, std::size_t channels) noexcept -> std::size_t
+    {
+        return layout == channel_layout::planar ? round_to_lines(frames) * channels : round_to_lines(frames * channels);
+    }
+
+    [[nodiscard]] auto block(std::size_t index) const -> data_type * { return a.offset(index * slot_elements); }
+
+    [[nodiscard]] auto plane(std::size_t index, std::size_t channel) const -> data_type *
+    {
+        return a.offset(index * slot_elements + channel * plane_elements);
+    }
+
+    [[nodiscard]] auto block_index(std::size_t offset) const -> std::size_t
+    {
+        if (offset < size() && offset % block_size() == 0)
+        {
+            return offset / block_size();
+        }
+        throw std::runtime_error("invalid block offset");
+    }
+
+    /// @brief Copy out of block `index` with `copy` until no write overlapped the copy
+    template <typename copier>
+    void read_consistent(std::size_t index, copier &&copy)
+    {
+        auto &seq = cursors[index].seq;
+        std::size_t seq0;
+        std::size_t seq1;
+        do
+        {
+            seq0 = seq.load(std::memory_order_acquire);
+            std::atomic_signal_fence(std::memory_order_acq_rel);
+            copy();
+            copy_policy::read_fence();
+            seq1 = seq.load(std::memory_order_acquire);
+        } while (seq0 != seq1 || seq0 & 1);
+    }
+
+public:
+    using value_type = data_type;
+
+    channel_seqlock_solution(std::size_t num_blocks, std::size_t frames, std::size_t channels, const page_options &pages = {})
+        : n_blocks(num_blocks),
+          n_frames(frames),
+          n_channels(channels),
+          plane_elements(layout == channel_layout::planar ? round_to_lines(frames) : 1),
+          slot_elements(slot_size(frames, channels)),
+          cursors(num_blocks),
+          published{0},
+          index_write(0),
+          a(num_blocks * slot_size(frames, channels), pages)
+    {
+        if (num_blocks == 0 || frames == 0 || channels == 0)
+        {
+            throw std::runtime_error("a ring of frames needs blocks, frames and channels");
+        }
+    }
+
+    /// @brief Elements in a block, frames times channels
+    [[nodiscard]] auto block_size() const noexcept -> std::size_t { return n_frames * n_channels; }
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return n_blocks * block_size(); }
+    [[nodiscard]] auto channels() const noexcept -> std::size_t { return n_channels; }
+    [[nodiscard]] auto backend() const noexcept -> page_backend { return a.backend(); }
+
+    void fill(data_type value)
+    {
+        std::fill_n(a.data(), a.size(), value);
+    }
+
+    /// @brief Write one block of `size` interleaved samples, frames times channels
+    void write(const data_type *src, std::size_t size)
+    {
+        if (src != nullptr && size == block_size())
+        {
+            auto &seq = cursors[index_write].seq;
+            const std::size_t seq0 = seq.load(std::memory_order_relaxed);
+            seq.store(seq0 + 1, std::memory_order_release);
+            copy_policy::write_fence();
+            if constexpr (layout == channel_layout::interleaved)
+            {
+                copy_policy::store(block(index_write), src, size);
+            }
+            else
+            {
+                for (std::size_t c = 0; c < n_channels; ++c)
+                {
+                    data_type *dst = plane(index_write, c);
+                    for (std::size_t f = 0; f < n_frames; ++f)
+                    {
+                        copy_policy::store(dst + f, src + f * n_channels + c, 1);
+                    }
+                }
+            }
+            std::atomic_signal_fence(std::memory_order_acq_rel);
+            seq.store(seq0 + 2, std::memory_order_release);
+            published.seq.store(published.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            index_write = (index_write + 1) % n_blocks;
+            return;
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+
+    /// @brief Read the whole block at `offset` as interleaved frames
+    void read(data_type *dst, std::size_t size, std::size_t offset)
+    {
+        if (dst != nullptr && size == block_size())
+        {
+            const std::size_t index = block_index(offset);
+            read_consistent(index, [&]
+                            {
+                if constexpr (layout == channel_layout::interleaved)
+                {
+                    copy_policy::load(dst, block(index), size);
+                }
+                else
+                {
+                    for (std::size_t c = 0; c < n_channels; ++c)
+                    {
+                        const data_type *src = plane(index, c);
+                        for (std::size_t f = 0; f < n_frames; ++f)
+                        {
+                            copy_policy::load(dst + f * n_channels + c, src + f, 1);
+                        }
+                    }
+                } });
+            return;
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+
+    /// @brief Read the `frames` samples of one channel of the block at `offset`
+    void read_channel(data_type *dst, std::size_t frames, std::size_t offset, std::size_t channel)
+    {
+        if (dst != nullptr && frames == n_frames && channel < n_channels)
+        {
+            const std::size_t index = block_index(offset);
+            read_consistent(index, [&]
+                            {
+                if constexpr (layout == channel_layout::interleaved)
+                {
+                    const data_type *src = block(index) + channel;
+                    for (std::size_t f = 0; f < n_frames; ++f)
+                    {
+                        copy_policy::load(dst + f, src + f * n_channels, 1);
+                    }
+                }
+                else
+                {
+                    copy_policy::load(dst, plane(index, channel), n_frames);
+                } });
+            return;
+        }
+        throw std::runtime_error("invalid pointer, frame count or channel");
+    }
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+/// Helper types for consumers that follow the sequence of blocks published by the writer
+
+enum class read_status
+{
+    ok,       // a block was copied into the destination buffer
+    not_ready // the consumer has already read every published block
+};
+
+/// @brief Outcome of a single read_next call
+struct read_result
+{
+    read_status status;
+    std::size_t lost; // blocks overwritten by the writer before this consumer could read them
+};
+
+/// @brief Read position of a single consumer. Each consumer thread owns its own cursor
+struct consumer_cursor
+{
+    std::size_t next{0}; // global sequence number of the next block to read
+    std::size_t lost{0}; // total number of blocks skipped because the writer lapped the consumer
+};
@@ -0,0 +1,296 @@
+#pragma once
+
+#include "aligned_array.hpp"
+#include "benchmark.hpp"
+#include "consumer.hpp"
+#include "latency_histogram.hpp"
+#include "timer.hpp"
+#include "wait_strategy.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <latch>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// Consumers as C++20 coroutines, so that many of them can share a few threads instead of one
+/// thread each. A consumer waits for its next block with `co_await scheduler.next_block(dst, cursor)`.
+/// If the block is already published the read happens at once and the consumer carries on.
+/// Otherwise the consumer is parked and its scheduler, which runs every consumer given to it on a
+/// single thread, resumes it once the writer has published the block
+
+/// @brief Coroutine of one consumer. It starts suspended and is owned by the scheduler it is spawned on
+class consumer_task
+{
+public:
+    struct promise_type
+    {
+        std::exception_ptr exception;
+
+        auto get_return_object() -> consumer_task { return consumer_task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+        auto final_suspend() noexcept -> std::suspend_always { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { exception = std::current_exception(); }
+    };
+
+    consumer_task(consumer_task &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+    consumer_task &operator=(consumer_task &&other) noexcept
+    {
+        std::swap(handle, other.handle);
+        return *this;
+    }
+    consumer_task(const consumer_task &) = delete;
+    consumer_task &operator=(const consumer_task &) = delete;
+
+    ~consumer_task()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    /// @brief Run the consumer until it waits for a block or returns, rethrowing whatever it threw
+    void resume() const
+    {
+        handle.resume();
+        rethrow_if_failed();
+    }
+
+    [[nodiscard]] bool done() const noexcept { return handle.done(); }
+
+    void rethrow_if_failed() const
+    {
+        if (handle.done() && handle.promise().exception)
+        {
+            std::rethrow_exception(handle.promise().exception);
+        }
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit consumer_task(std::coroutine_handle<promise_type> h) : handle(h) {}
+};
+
+/// @brief Solutions whose consumers can follow the sequence of published blocks
+template <typename solution, typename data_type>
+concept sequenced_solution = requires(solution &store, data_type *p, std::size_t n, consumer_cursor &c) {
+    { store.head() } -> std::convertible_to<std::size_t>;
+    { store.read_next(p, n, c) } -> std::same_as<read_result>;
+};
+
+/// @brief Single-threaded scheduler of coroutine consumers reading from one ring
+template <typename solution, typename data_type>
+    requires sequenced_solution<solution, data_type>
+class block_scheduler
+{
+public:
+    /// @brief Result of next_block(). Reads the block when awaited and suspends only if it is not published yet
+    class next_block_awaiter
+    {
+        block_scheduler *scheduler;
+        data_type *dst;
+        consumer_cursor *consumer;
+        latency_histogram *latency;
+        read_result result{read_status::not_ready, 0};
+
+        friend class block_scheduler;
+
+        bool try_read()
+        {
+            if (latency == nullptr)
+            {
+                result = scheduler->store.read_next(dst, scheduler->b_size, *consumer);
+                return result.status == read_status::ok;
+            }
+            const std::uint64_t t0 = scheduler->timer.start();
+            result = scheduler->store.read_next(dst, scheduler->b_size, *consumer);
+            const std::uint64_t ns = scheduler->timer.elapsed_ns(t0, scheduler->timer.stop());
+            if (result.status == read_status::ok)
+            {
+                latency->record(ns);
+            }
+            return result.status == read_status::ok;
+        }
+
+    public:
+        next_block_awaiter(block_scheduler *s, data_type *d, consumer_cursor *c, latency_histogram *l)
+            : scheduler(s), dst(d), consumer(c), latency(l)
+        {
+        }
+
+        bool await_ready() { return try_read(); }
+        void await_suspend(std::coroutine_handle<> handle) { scheduler->parked.push_back({handle, this}); }
+        auto await_resume() const noexcept -> read_result { return result; }
+    };
+
+    block_scheduler(solution &s, std::size_t block_size) : store(s), b_size(block_size) {}
+
+    block_scheduler(const block_scheduler &) = delete;
+    block_scheduler &operator=(const block_scheduler &) = delete;
+
+    /// @brief Awaitable copying the consumer's next block into `dst`, the time of successful reads goes to `latency`
+    auto next_block(data_type *dst, consumer_cursor &consumer, latency_histogram *latency = nullptr) -> next_block_awaiter
+    {
+        return next_block_awaiter(this, dst, &consumer, latency);
+    }
+
+    /// @brief Hand a consumer to the scheduler, it starts when run() is called
+    void spawn(consumer_task task) { tasks.push_back(std::move(task)); }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return tasks.size(); }
+
+    /// @brief Run every consumer until all of them have returned. While none of the parked
+    /// consumers has a block to read, the thread spins until the writer publishes the next one
+    void run()
+    {
+        for (const auto &task : tasks)
+        {
+            task.resume();
+        }
+        while (!parked.empty())
+        {
+            const std::size_t seen = store.head();
+            std::swap(parked, waking);
+            bool progressed = false;
+            for (const auto &[handle, awaiter] : waking)
+            {
+                if (awaiter->try_read())
+                {
+                    progressed = true;
+                    handle.resume();
+                }
+                else
+                {
+                    parked.push_back({handle, awaiter});
+                }
+            }
+            waking.clear();
+            if (!progressed)
+            {
+                spin_until([this, seen]
+                           { return store.head() != seen; });
+            }
+        }
+        // a consumer that threw has returned without parking again
+        for (const auto &task : tasks)
+        {
+            task.rethrow_if_failed();
+        }
+    }
+
+private:
+    struct parked_consumer
+    {
+        std::coroutine_handle<> handle;
+        next_block_awaiter *awaiter;
+    };
+
+    solution &store;
+    std::size_t b_size;
+    benchmark_timer timer;
+    std::vector<consumer_task> tasks;
+    std::vector<parked_consumer> parked;
+    std::vector<parked_consumer> waking;
+};
+
+/// @brief Consumer coroutine reading every block the writer publishes, until `cycles` blocks
+/// have been read or lost. The read latency of each block goes to `histogram`
+template <typename solution, typename data_type>
+consumer_task coroutine_reader(block_scheduler<solution, data_type> &scheduler,
+                               data_type *dst,
+                               consumer_cursor &consumer,
+                               std::size_t cycles,
+                               latency_histogram &histogram)
+{
+    while (consumer.next < cycles)
+    {
+        co_await scheduler.next_block(dst, consumer, &histogram);
+    }
+}
+
+/// @brief Thread running one scheduler and the consumers it was given
+template <typename solution, typename data_type>
+void scheduler_thread(block_scheduler<solution, data_type> &scheduler, std::size_t index, std::latch &thread_latch)
+{
+    spdlog::info("Scheduler {} starts with {} consumers", index, scheduler.size());
+    thread_latch.arrive_and_wait();
+    scheduler.run();
+    spdlog::info("Scheduler {} terminates", index);
+}
+
+/// @brief The writer and `num_consumers` coroutine consumers spread round robin over
+/// `num_threads` scheduler threads. Reader times are the mean read time of each consumer
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+benchmark_results run_coroutine_benchmark(std::size_t num_blocks,
+                                          std::size_t block_size,
+                                          std::size_t num_consumers,
+                                          std::size_t cycles,
+                                          std::size_t num_threads = 1)
+{
+    num_threads = std::clamp<std::size_t>(num_threads, 1, std::max<std::size_t>(num_consumers, 1));
+    solution store(num_blocks, block_size);
+    store.fill(data_type{12345});
+
+    std::latch thread_latch(num_threads + 1);
+    benchmark_results results{std::vector<double>(num_consumers + 1), std::vector<std::size_t>(num_consumers)};
+    results.labels.emplace_back("clock_source", to_string(clock_ticks::calibration().source));
+    results.labels.emplace_back("scheduler_threads", std::to_string(num_threads));
+    std::vector<double> &times = results.times;
+    perf_counts writer_counts;
+
+    // consumers keep a reference to their scheduler, so the schedulers never move
+    std::deque<block_scheduler<solution, data_type>> schedulers;
+    for (std::size_t k = 0; k < num_threads; ++k)
+    {
+        schedulers.emplace_back(store, block_size);
+    }
+    std::vector<aligned_array<data_type, alignment_bytes>> buffers;
+    buffers.reserve(num_consumers);
+    std::vector<consumer_cursor> cursors(num_consumers);
+    std::vector<latency_histogram> histograms(num_consumers);
+    for (std::size_t k = 0; k < num_consumers; ++k)
+    {
+        buffers.emplace_back(block_size);
+        auto &scheduler = schedulers[k % num_threads];
+        scheduler.spawn(coroutine_reader(scheduler, buffers[k].data(), cursors[k], cycles, histograms[k]));
+    }
+
+    std::thread writer_thread(writer<solution, data_type, alignment_bytes>,
+                              std::ref(store),
+                              block_size,
+                              cycles,
+                              std::size_t{1},
+                              std::size_t{1},
+                              std::ref(thread_latch),
+                              std::ref(times[0]),
+                              std::ref(results.write_latency),
+                              std::ref(writer_counts));
+
+    std::vector<std::thread> threads;
+    for (std::size_t k = 0; k < num_threads; ++k)
+    {
+        threads.emplace_back(scheduler_thread<solution, data_type>, std::ref(schedulers[k]), k, std::ref(thread_latch));
+    }
+
+    writer_thread.join();
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    for (std::size_t k = 0; k < num_consumers; ++k)
+    {
+        times[k + 1] = histograms[k].mean();
+        results.lost[k] = cursors[k].lost;
+        results.read_latency.merge(histograms[k]);
+    }
+
+    return results;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "aligned_array.hpp"
+#include "atomic_copy.hpp"
+#include "consumer.hpp"
+#include "seqlock_solution.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/// @brief seqlock_solution with the ring geometry fixed at compile time. Both sizes are powers
+/// of two, so ring offsets wrap with a mask and block indices are shifts, and every copy has a
+/// constant length the compiler can unroll or vectorise. Offsets are masked instead of checked,
+/// so the hot path never branches on its arguments or throws: the benchmark passes correct
+/// sizes by construction. The constructor keeps the runtime signature and rejects a geometry
+/// other than the one the type was instantiated with
+template <typename data_type, std::size_t alignment_bytes, std::size_t num_blocks, std::size_t block_size, typename copy_policy = memcpy_copy>
+    requires(std::has_single_bit(num_blocks) && std::has_single_bit(block_size))
+class fixed_seqlock_solution
+{
+    static constexpr std::size_t ring_size = num_blocks * block_size;
+    static constexpr std::size_t ring_mask = ring_size - 1;
+    static constexpr std::size_t block_mask = num_blocks - 1;
+    static constexpr int block_shift = std::countr_zero(block_size);
+    // every block starts at a multiple of its own size in bytes, so at the largest power of two
+    // dividing that size, capped by the array alignment
+    static constexpr std::size_t block_alignment = std::min(alignment_bytes, std::size_t{1} << std::countr_zero(block_size * sizeof(data_type)));
+
+    std::vector<cursor<>> cursors;
+    cursor<> published;
+    std::size_t offset_write;
+    aligned_array<data_type, alignment_bytes> a;
+
+    [[nodiscard]] auto block(std::size_t offset) const noexcept -> data_type *
+    {
+        return std::assume_aligned<block_alignment>(a.unchecked_offset(offset & ring_mask));
+    }
+
+public:
+    fixed_seqlock_solution(std::size_t blocks, std::size_t size, const page_options &pages = {})
+        : cursors(num_blocks),
+          published{0},
+          offset_write(0),
+          a(ring_size, pages)
+    {
+        if (blocks != num_blocks || size != block_size)
+        {
+            throw std::runtime_error("ring geometry differs from the one fixed at compile time");
+        }
+    }
+    ~fixed_seqlock_solution() = default;
+
+    [[nodiscard]] static constexpr auto size() noexcept -> std::size_t { return ring_size; }
+    [[nodiscard]] auto backend() const noexcept -> page_backend { return a.backend(); }
+
+    /// @brief Number of blocks written so far. Block k of the global sequence is stored at index k & (num_blocks - 1)
+    [[nodiscard]] auto head() const noexcept -> std::size_t { return published.seq.load(std::memory_order_acquire); }
+
+    void fill(data_type value)
+    {
+        fill_array(a, value);
+    }
+
+    /// @brief Write one block, `size` must be `block_size`
+    void write(const data_type *src, [[maybe_unused]] std::size_t size) noexcept
+    {
+        auto &seq = cursors[offset_write >> block_shift].seq;
+        const std::size_t seq0 = seq.load(std::memory_order_relaxed);
+        seq.store(seq0 + 1, std::memory_order_release);
+        copy_policy::write_fence();
+        copy_policy::store(block(offset_write), src, block_size);
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+        seq.store(seq0 + 2, std::memory_order_release);
+        published.seq.store(published.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        offset_write = (offset_write + block_size) & ring_mask;
+    }
+
+    /// @brief Read the block at `offset`, `size` must be `block_size` and `offset` a multiple of it
+    void read(data_type *dst, [[maybe_unused]] std::size_t size, std::size_t offset) noexcept
+    {
+        auto &seq = cursors[(offset >> block_shift) & block_mask].seq;
+        std::size_t seq0;
+        std::size_t seq1;
+        do
+        {
+            seq0 = seq.load(std::memory_order_acquire);
+            std::atomic_signal_fence(std::memory_order_acq_rel);
+            copy_policy::load(dst, block(offset), block_size);
+            copy_policy::read_fence();
+            seq1 = seq.load(std::memory_order_acquire);
+        } while (seq0 != seq1 || seq0 & 1);
+    }
+
+    /// @brief Read the oldest block the consumer has not seen yet, see seqlock_solution::read_next
+    auto read_next(data_type *dst, [[maybe_unused]] std::size_t size, consumer_cursor &consumer) noexcept -> read_result
+    {
+        std::size_t lost{0};
+        while (true)
+        {
+            const std::size_t head_seq = published.seq.load(std::memory_order_acquire);
+            if (consumer.next >= head_seq)
+            {
+                return {read_status::not_ready, lost};
+            }
+            if (head_seq - consumer.next > num_blocks)
+            {
+                lost += head_seq - num_blocks - consumer.next;
+                consumer.next = head_seq - num_blocks;
+            }
+
+            const std::size_t index = consumer.next & block_mask;
+            const std::size_t expected = 2 * (consumer.next / num_blocks + 1);
+            auto &seq = cursors[index].seq;
+            if (seq.load(std::memory_order_acquire) == expected)
+            {
+                std::atomic_signal_fence(std::memory_order_acq_rel);
+                copy_policy::load(dst, block(index << block_shift), block_size);
+                copy_policy::read_fence();
+                if (seq.load(std::memory_order_acquire) == expected)
+                {
+                    ++consumer.next;
+                    consumer.lost += lost;
+                    return {read_status::ok, lost};
+                }
+            }
+        }
+    }
+};
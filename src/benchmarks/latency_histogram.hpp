@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/// @brief Log-linear histogram of latencies in ns, in the spirit of HdrHistogram. Every power of
+/// two is split into `sub_buckets` equal buckets, so any recorded value is known to within
+/// 1 / sub_buckets (about 1.6%). The counts live in a fixed array: record() never allocates and
+/// costs a bit scan plus an increment. Values above max_trackable are counted in the last bucket
+class latency_histogram
+{
+public:
+    static constexpr unsigned sub_bucket_bits = 6;
+    static constexpr std::uint64_t sub_buckets = std::uint64_t{1} << sub_bucket_bits;
+    static constexpr unsigned max_bits = 40; // about 18 minutes in ns
+    static constexpr std::uint64_t max_trackable = (std::uint64_t{1} << max_bits) - 1;
+    static constexpr std::size_t bucket_count = sub_buckets * (max_bits - sub_bucket_bits + 1);
+
+private:
+    std::array<std::uint64_t, bucket_count> counts{};
+    std::uint64_t total{0};
+    std::uint64_t min_value{std::numeric_limits<std::uint64_t>::max()};
+    std::uint64_t max_value{0};
+    double sum{0.0};
+
+public:
+    void record(std::uint64_t value) noexcept
+    {
+        ++counts[index_of(value)];
+        ++total;
+        min_value = std::min(min_value, value);
+        max_value = std::max(max_value, value);
+        sum += static_cast<double>(value);
+    }
+
+    void merge(const latency_histogram &other) noexcept
+    {
+        for (std::size_t k = 0; k < bucket_count; ++k)
+        {
+            counts[k] += other.counts[k];
+        }
+        total += other.total;
+        min_value = std::min(min_value, other.min_value);
+        max_value = std::max(max_value, other.max_value);
+        sum += other.sum;
+    }
+
+    void reset() noexcept
+    {
+        *this = latency_histogram{};
+    }
+
+    [[nodiscard]] auto count() const noexcept -> std::uint64_t { return total; }
+    [[nodiscard]] auto min() const noexcept -> std::uint64_t { return total > 0 ? min_value : 0; }
+    [[nodiscard]] auto max() const noexcept -> std::uint64_t { return max_value; }
+    [[nodiscard]] auto mean() const noexcept -> double { return total > 0 ? sum / static_cast<double>(total) : 0.0; }
+
+    /// @brief Smallest value such that `percentile` percent of the recorded values are not above it,
+    /// reported as the upper edge of its bucket and never above the largest recorded value
+    [[nodiscard]] auto value_at_percentile(double percentile) const noexcept -> std::uint64_t
+    {
+        if (total == 0)
+        {
+            return 0;
+        }
+        const double clamped = std::clamp(percentile, 0.0, 100.0);
+        const auto target = std::max<std::uint64_t>(
+            static_cast<std::uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total))), 1);
+        std::uint64_t cumulative{0};
+        for (std::size_t k = 0; k < bucket_count; ++k)
+        {
+            cumulative += counts[k];
+            if (cumulative >= target)
+            {
+                return std::clamp(upper_edge(k), min(), max_value);
+            }
+        }
+        return max_value;
+    }
+
+    /// @brief Bucket of `value`: values below sub_buckets map one to one, above that every power
+    /// of two [2^m, 2^(m+1)) is divided into sub_buckets buckets of width 2^(m - sub_bucket_bits)
+    [[nodiscard]] static constexpr auto index_of(std::uint64_t value) noexcept -> std::size_t
+    {
+        value = std::min(value, max_trackable);
+        if (value < sub_buckets)
+        {
+            return static_cast<std::size_t>(value);
+        }
+        const unsigned msb = static_cast<unsigned>(std::bit_width(value)) - 1;
+        const unsigned shift = msb - sub_bucket_bits;
+        return static_cast<std::size_t>((shift + 1) * sub_buckets + (value >> shift) - sub_buckets);
+    }
+
+    /// @brief Largest value that maps to bucket `index`
+    [[nodiscard]] static constexpr auto upper_edge(std::size_t index) noexcept -> std::uint64_t
+    {
+        if (index < sub_buckets)
+        {
+            return index;
+        }
+        const std::uint64_t shift = index / sub_buckets - 1;
+        const std::uint64_t first = (sub_buckets + index % sub_buckets) << shift;
+        return first + (std::uint64_t{1} << shift) - 1;
+    }
+};
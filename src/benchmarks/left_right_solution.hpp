@@ -0,0 +1,116 @@
+#pragma once
+
+#include "aligned_array.hpp"
+#include "seqlock_solution.hpp"
+#include "wait_strategy.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+/// @brief Left-Right ring (P. Ramalhete and A. Correia): two full copies of the ring, readers
+/// always read the copy the writer is not touching. A reader announces itself on a read
+/// indicator, reads and departs without ever looping, so reads are wait-free and never retried.
+/// The writer pays instead: it writes the block into the idle copy, switches the readers over,
+/// waits until every reader that could still be on the old copy has departed, and then writes
+/// the block a second time to bring the old copy up to date.
+///
+/// Read indicators are striped: every reader thread takes its own padded counter on first use,
+/// readers beyond `stripes` share counters
+template <typename data_type, std::size_t alignment_bytes, std::size_t stripes = 16>
+class left_right_solution
+{
+    using read_indicator = std::array<cursor<>, stripes>;
+
+    std::size_t n_blocks;
+    std::size_t b_size;
+    std::size_t offset_write;
+    cursor<> left_right; // copy the readers read
+    cursor<> version;    // read indicator new readers arrive on
+    std::array<read_indicator, 2> indicators;
+    std::array<aligned_array<data_type, alignment_bytes>, 2> copies;
+
+    [[nodiscard]] static auto stripe() noexcept -> std::size_t
+    {
+        static std::atomic<std::size_t> next_stripe{0};
+        static thread_local const std::size_t mine = next_stripe.fetch_add(1, std::memory_order_relaxed) % stripes;
+        return mine;
+    }
+
+    [[nodiscard]] bool empty(const read_indicator &indicator) const noexcept
+    {
+        for (const auto &c : indicator)
+        {
+            if (c.seq.load() != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// @brief Switch the readers to copy `next` and wait until none can still be on the other one
+    void toggle(std::size_t next) noexcept
+    {
+        left_right.seq.store(next);
+        const std::size_t previous = version.seq.load(std::memory_order_relaxed);
+        spin_until([this, previous]
+                   { return empty(indicators[1 - previous]); });
+        version.seq.store(1 - previous);
+        spin_until([this, previous]
+                   { return empty(indicators[previous]); });
+    }
+
+public:
+    left_right_solution(std::size_t num_blocks, std::size_t block_size, const page_options &pages = {})
+        : n_blocks(num_blocks),
+          b_size(block_size),
+          offset_write(0),
+          left_right{0},
+          version{0},
+          indicators{},
+          copies{aligned_array<data_type, alignment_bytes>(num_blocks * block_size, pages),
+                 aligned_array<data_type, alignment_bytes>(num_blocks * block_size, pages)}
+    {
+    }
+    ~left_right_solution() = default;
+
+    [[nodiscard]] auto size() noexcept -> std::size_t { return n_blocks * b_size; }
+    [[nodiscard]] auto backend() const noexcept -> page_backend { return copies[0].backend(); }
+
+    void fill(data_type value)
+    {
+        fill_array(copies[0], value);
+        fill_array(copies[1], value);
+    }
+
+    void write(const data_type *src, std::size_t size)
+    {
+        if (src != nullptr && size == b_size)
+        {
+            const std::size_t idle = 1 - left_right.seq.load(std::memory_order_relaxed);
+            std::memcpy(copies[idle].offset(offset_write), src, size * sizeof(data_type));
+            toggle(idle);
+            std::memcpy(copies[1 - idle].offset(offset_write), src, size * sizeof(data_type));
+            offset_write += size;
+            offset_write = offset_write % copies[0].size();
+            return;
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+
+    void read(data_type *dst, std::size_t size, std::size_t offset)
+    {
+        if (dst != nullptr && size == b_size)
+        {
+            auto &indicator = indicators[version.seq.load()][stripe()].seq;
+            indicator.fetch_add(1);
+            const std::size_t current = left_right.seq.load();
+            std::memcpy(dst, copies[current].offset(offset), size * sizeof(data_type));
+            indicator.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+};
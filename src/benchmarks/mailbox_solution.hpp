@@ -0,0 +1,104 @@
+#pragma once
+
+#include "aligned_array.hpp"
+#include "seqlock_solution.hpp"
+#include "wait_strategy.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/// @brief Latest-value mailbox, a triple buffer generalised to several readers. Every reader
+/// gets the newest complete block, older blocks are simply dropped. The `num_blocks` slots are
+/// not a ring: one holds the newest block, the writer fills a free one and swaps it in.
+///
+/// Readers never retry. `latest` packs the index of the newest slot with the number of readers
+/// that took it, so a reader acquires the slot and counts itself in a single fetch-add, copies
+/// the block and then counts its departure on the slot. When the writer swaps a slot out it
+/// subtracts the readers it took with it from the departures: the slot is free again once that
+/// balance is back to zero. With at least readers + 2 slots a free slot always exists and the
+/// writer never waits; with fewer it waits for a reader to leave
+template <typename data_type, std::size_t alignment_bytes>
+class mailbox_solution
+{
+    static constexpr unsigned index_shift = 32;
+    static constexpr std::uint64_t count_mask = (std::uint64_t{1} << index_shift) - 1;
+
+    std::size_t n_slots;
+    std::size_t b_size;
+    std::size_t current; // slot published last, only touched by the writer
+    cursor<> latest;
+    std::vector<cursor<>> balance; // departures minus the readers taken out with the slot, modulo 2^64
+    aligned_array<data_type, alignment_bytes> a;
+
+    [[nodiscard]] auto free_slot() const noexcept -> std::size_t
+    {
+        std::size_t found = n_slots;
+        spin_until([this, &found]
+                   {
+                       for (std::size_t k = 1; k < n_slots; ++k)
+                       {
+                           const std::size_t slot = (current + k) % n_slots;
+                           if (balance[slot].seq.load(std::memory_order_acquire) == 0)
+                           {
+                               found = slot;
+                               return true;
+                           }
+                       }
+                       return false; });
+        return found;
+    }
+
+public:
+    mailbox_solution(std::size_t num_blocks, std::size_t block_size, const page_options &pages = {})
+        : n_slots(num_blocks),
+          b_size(block_size),
+          current(0),
+          latest{0},
+          balance(num_blocks),
+          a(num_blocks * block_size, pages)
+    {
+        if (num_blocks < 2)
+        {
+            throw std::runtime_error("a mailbox needs at least two slots");
+        }
+    }
+    ~mailbox_solution() = default;
+
+    [[nodiscard]] auto size() noexcept -> std::size_t { return n_slots * b_size; }
+    [[nodiscard]] auto backend() const noexcept -> page_backend { return a.backend(); }
+
+    void fill(data_type value)
+    {
+        fill_array(a, value);
+    }
+
+    void write(const data_type *src, std::size_t size)
+    {
+        if (src != nullptr && size == b_size)
+        {
+            const std::size_t slot = free_slot();
+            std::memcpy(a.offset(slot * b_size), src, size * sizeof(data_type));
+            const std::uint64_t previous = latest.seq.exchange(static_cast<std::uint64_t>(slot) << index_shift, std::memory_order_acq_rel);
+            balance[previous >> index_shift].seq.fetch_sub(previous & count_mask, std::memory_order_relaxed);
+            current = slot;
+            return;
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+
+    /// @brief Copy the newest block, `offset` is ignored since the mailbox only keeps the latest value
+    void read(data_type *dst, std::size_t size, [[maybe_unused]] std::size_t offset)
+    {
+        if (dst != nullptr && size == b_size)
+        {
+            const std::size_t slot = latest.seq.fetch_add(1, std::memory_order_acquire) >> index_shift;
+            std::memcpy(dst, a.offset(slot * b_size), size * sizeof(data_type));
+            balance[slot].seq.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+};
@@ -2,40 +2,108 @@
 #include "unsynchronised_solution.hpp"
 #include "synchronised_solution.hpp"
 #include "seqlock_solution.hpp"
+#include "fixed_seqlock_solution.hpp"
+#include "mpmc_solution.hpp"
+#include "left_right_solution.hpp"
+#include "mailbox_solution.hpp"
+#include "variable_benchmark.hpp"
+#include "shm_benchmark.hpp"
+#include "wait_benchmark.hpp"
+#include "paced_benchmark.hpp"
+#include "coroutine_consumer.hpp"
+#include "channel_benchmark.hpp"
+#include "pipeline_benchmark.hpp"
 #include "zmq_benchmark.hpp"
+#include "repetitions.hpp"
+#include "sweep.hpp"
+
+#include <cxxopts.hpp>
 
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/fmt/fmt.h>
+#include <spdlog/fmt/ranges.h>
 
 #include <string>
 #include <shared_mutex>
 #include <mutex>
 #include <vector>
 #include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 struct parameters
 {
     std::size_t num_blocks{10};
     std::size_t block_size{16};
     std::size_t num_readers{3};
+    std::size_t num_writers{1};
     std::size_t num_cycles{1000000};
+    std::size_t batch_size{1};
+    std::size_t sample_every{1}; // time one operation in sample_every
+    std::size_t wait_cycles{100000};
+    std::uint64_t wait_interval_ns{10000};
+    std::chrono::milliseconds throughput_duration{1000}; // length of throughput and paced runs
+    double sample_rate{48000.0};                         // paced mode: one block every block_size / sample_rate seconds
+    std::uint64_t paced_jitter_ns{0};
+    double deadline_fraction{1.0}; // paced mode: consumer deadline after each arrival, in periods
+    std::size_t coroutine_threads{1}; // coroutines mode: scheduler threads shared by the consumers
+    std::size_t num_channels{8};      // channels mode: samples per frame, block_size counts frames
+    std::string pipeline;             // pipeline mode: graph of stages, see pipeline_config::parse
+    std::uint64_t pipeline_period_ns{0}; // pipeline mode: source period, 0 writes as fast as possible
+    std::size_t warmup_cycles{0}; // cycles of a discarded run before the measured ones, 0 disables it
+    std::size_t repetitions{1};
+    std::string data_type{"uint64"};
+    placement thread_placement{placement::none}; // pinning of the writer and readers, see topology.hpp
     bool enable_memcpy{true};
     bool enable_seqlock{true};
+    bool enable_seqlock_sequenced{true};
+    bool enable_seqlock_atomic{true};
+    bool enable_seqlock_view{true};
+    bool enable_seqlock_streaming{true};
+    bool enable_seqlock_fixed{true};
+    bool enable_seqlock_layouts{true};
     bool enable_shared_lock{true};
     bool enable_mutex_lock{true};
+    bool enable_variable{true};
+    bool enable_mpmc{true};
+    bool enable_left_right{true};
+    bool enable_mailbox{true};
+    bool enable_shm{true};
     bool enable_zmq{true};
+    std::vector<zmq_transport> zmq_transports{zmq_transport::inproc, zmq_transport::ipc, zmq_transport::tcp};
+    int zmq_high_water_mark{1000};
+    bool zmq_conflate{false};
+    frame_distribution frames{};
+    page_options pages{};
+};
+
+/// @brief One implementation run with one set of parameters
+struct measurement
+{
+    std::string name;
+    parameters params;
+    benchmark_results results;
 };
 
-inline std::string print_results(const std::string &message, const parameters &params, std::vector<double> &times, const char separator = ' ')
+inline std::string print_results(const std::string &message, const parameters &params, const repeated_results &repeated, const char separator = ' ')
 {
+    const benchmark_results &results = repeated.combined;
+    const std::vector<double> &times = results.times;
     std::string s = fmt::format("{}", "{\n");
     s += fmt::format("\"implementation\": \"{}\",\n", message);
+    s += fmt::format("\"data_type\": \"{}\",\n", params.data_type);
     s += fmt::format("\"num_cycles\": \"{}\",\n", params.num_cycles);
     s += fmt::format("\"block_size\": \"{}\",\n", params.block_size);
     s += fmt::format("\"num_blocks\": \"{}\",\n", params.num_blocks);
     s += fmt::format("\"num_readers\": \"{}\",\n", params.num_readers);
+    s += fmt::format("\"num_writers\": \"{}\",\n", params.num_writers);
+    s += fmt::format("\"batch_size\": \"{}\",\n", params.batch_size);
+    s += fmt::format("\"sample_every\": \"{}\",\n", params.sample_every);
+    s += fmt::format("\"repetitions\": \"{}\",\n", repeated.repetitions);
     s += fmt::format("\"writer\": {:.1f},\n", times[0]);
     s += fmt::format("\"readers\": [");
     std::vector<double> sorted(std::begin(times) + 1, std::end(times));
@@ -44,18 +112,164 @@ inline std::string print_results(const std::string &message, const parameters &p
     {
         s += fmt::format("{:.1f}, ", sorted[k]);
     }
-    s += fmt::format("{:.1f}]\n", sorted[sorted.size() - 1]);
+    s += fmt::format("{:.1f}]", sorted[sorted.size() - 1]);
+    if (!results.lost.empty())
+    {
+        s += fmt::format(",\n\"lost\": [{}]", fmt::join(results.lost, ", "));
+    }
+    if (!results.lag.empty())
+    {
+        s += fmt::format(",\n\"lag\": [{:.1f}]", fmt::join(results.lag, ", "));
+    }
+    const auto print_latency = [&s](const char *name, const latency_histogram &h)
+    {
+        if (h.count() > 0)
+        {
+            s += fmt::format(",\n\"{}\": {{\"p50\": {}, \"p90\": {}, \"p99\": {}, \"p99.9\": {}, \"max\": {}}}",
+                             name,
+                             h.value_at_percentile(50.0),
+                             h.value_at_percentile(90.0),
+                             h.value_at_percentile(99.0),
+                             h.value_at_percentile(99.9),
+                             h.max());
+        }
+    };
+    if (repeated.repetitions > 1)
+    {
+        s += fmt::format(",\n\"writer_stats\": {{\"mean\": {:.1f}, \"stddev\": {:.1f}, \"ci95\": {:.1f}}}",
+                         repeated.writer.mean, repeated.writer.stddev, repeated.writer.ci95);
+        s += fmt::format(",\n\"reader_stats\": {{\"mean\": {:.1f}, \"stddev\": {:.1f}, \"ci95\": {:.1f}}}",
+                         repeated.readers.mean, repeated.readers.stddev, repeated.readers.ci95);
+    }
+    print_latency("write_latency", results.write_latency);
+    print_latency("read_latency", results.read_latency);
+    for (const auto &[name, value] : results.labels)
+    {
+        s += fmt::format(",\n\"{}\": \"{}\"", name, value);
+    }
+    for (const auto &[name, value] : results.metrics)
+    {
+        s += fmt::format(",\n\"{}\": {:.1f}", name, value);
+    }
+    s += "\n";
     return s + fmt::format("{}{}\n", "}", separator);
 }
 
-std::string run_benchmark(const parameters &p)
+/// @brief ZeroMQ results are named after the transport, "ZMQ inproc" or "ZMQ tcp conflate" for instance
+inline std::string zmq_name(const zmq_options &options)
 {
-    std::string s;
+    return fmt::format("ZMQ {}{}", to_string(options.transport), options.conflate ? " conflate" : "");
+}
+
+/// @brief Publication-to-read latency and reader CPU usage of one consumer wait strategy, with the writer paced at p.wait_interval_ns
+template <typename solution, typename data_type>
+measurement run_wait_strategy(const parameters &p)
+{
+    constexpr std::size_t alignment_bytes{16};
+
+    parameters p_wait = p;
+    p_wait.num_cycles = std::min(p.num_cycles, p.wait_cycles);
+    const benchmark_results results = run_wait_benchmark<solution, data_type, alignment_bytes>(p_wait.num_blocks,
+                                                                                               p_wait.block_size,
+                                                                                               p_wait.num_readers,
+                                                                                               p_wait.num_cycles,
+                                                                                               p_wait.wait_interval_ns);
+    return {fmt::format("SeqLock wait {}", solution::wait_policy_type::name), p_wait, results};
+}
+
+/// Ring geometries compiled into fixed_seqlock_solution, the runtime-sized SeqLock covers all others
+using fixed_ring_lengths = std::index_sequence<8, 16>;
+using fixed_block_sizes = std::index_sequence<16, 64, 256, 1024, 4096, 16384>;
+
+template <typename data_type, std::size_t alignment_bytes, std::size_t num_blocks, typename runner, std::size_t... block_sizes>
+bool with_fixed_blocks(const parameters &p, runner &run, std::index_sequence<block_sizes...>)
+{
+    return ((p.num_blocks == num_blocks && p.block_size == block_sizes &&
+             (run.template operator()<fixed_seqlock_solution<data_type, alignment_bytes, num_blocks, block_sizes>>(), true)) ||
+            ...);
+}
+
+/// @brief Call `run` with the fixed_seqlock_solution type of the geometry in `p`.
+/// Returns false if that geometry is not one of the compiled ones
+template <typename data_type, std::size_t alignment_bytes, typename runner>
+bool with_fixed_geometry(const parameters &p, runner &&run)
+{
+    return [&]<std::size_t... ring_lengths>(std::index_sequence<ring_lengths...>)
+    { return (with_fixed_blocks<data_type, alignment_bytes, ring_lengths>(p, run, fixed_block_sizes{}) || ...); }(fixed_ring_lengths{});
+}
+
+/// @brief Solutions that take blocks from p.num_writers producers at once: the multi-producer ring
+/// and single producer solutions serialised by a mutex around every write
+template <typename data_type>
+std::vector<measurement> run_producers_benchmark(const parameters &p)
+{
+    std::vector<measurement> m;
 
     constexpr std::size_t alignment_bytes{16};
-    using data_type = std::uint64_t;
 
-    std::vector<double> results;
+    benchmark_results results;
+
+    if (p.enable_mpmc)
+    {
+        using mpmc_solution_type = mpmc_solution<data_type, alignment_bytes>;
+        results = run_benchmark<mpmc_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                p.block_size,
+                                                                                p.num_readers,
+                                                                                p.num_cycles,
+                                                                                std::size_t{1},
+                                                                                page_options{},
+                                                                                p.sample_every,
+                                                                                p.thread_placement,
+                                                                                p.num_writers);
+        m.push_back({"MPMC", p, results});
+    }
+
+    if (p.enable_seqlock)
+    {
+        using serialised_seqlock_type = serialised_producers<seqlock_solution<data_type, alignment_bytes>>;
+        results = run_benchmark<serialised_seqlock_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                     p.block_size,
+                                                                                     p.num_readers,
+                                                                                     p.num_cycles,
+                                                                                     std::size_t{1},
+                                                                                     page_options{},
+                                                                                     p.sample_every,
+                                                                                     p.thread_placement,
+                                                                                     p.num_writers);
+        m.push_back({"SeqLock serialised producers", p, results});
+    }
+
+    if (p.enable_mutex_lock)
+    {
+        using serialised_mutex_type = serialised_producers<exclusive_solution<data_type, alignment_bytes>>;
+        results = run_benchmark<serialised_mutex_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                   p.block_size,
+                                                                                   p.num_readers,
+                                                                                   p.num_cycles,
+                                                                                   std::size_t{1},
+                                                                                   page_options{},
+                                                                                   p.sample_every,
+                                                                                   p.thread_placement,
+                                                                                   p.num_writers);
+        m.push_back({"Mutex serialised producers", p, results});
+    }
+
+    return m;
+}
+
+template <typename data_type>
+std::vector<measurement> run_benchmark(const parameters &p)
+{
+    if (p.num_writers > 1)
+    {
+        return run_producers_benchmark<data_type>(p);
+    }
+
+    std::vector<measurement> m;
+
+    constexpr std::size_t alignment_bytes{16};
+
+    benchmark_results results;
 
     if (p.enable_memcpy)
     {
@@ -63,8 +277,12 @@ std::string run_benchmark(const parameters &p)
         results = run_benchmark<memcpy_solution_type, data_type, alignment_bytes>(p.num_blocks,
                                                                                   p.block_size,
                                                                                   p.num_readers,
-                                                                                  p.num_cycles);
-        s += print_results("Memcpy", p, results, ',');
+                                                                                  p.num_cycles,
+                                                                                  std::size_t{1},
+                                                                                  page_options{},
+                                                                                  p.sample_every,
+                                                                                  p.thread_placement);
+        m.push_back({"Memcpy", p, results});
     }
 
     if (p.enable_seqlock)
@@ -73,8 +291,145 @@ std::string run_benchmark(const parameters &p)
         results = run_benchmark<seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
                                                                                    p.block_size,
                                                                                    p.num_readers,
-                                                                                   p.num_cycles);
-        s += print_results("SeqLock", p, results, ',');
+                                                                                   p.num_cycles,
+                                                                                   std::size_t{1},
+                                                                                   page_options{},
+                                                                                   p.sample_every,
+                                                                                   p.thread_placement);
+        m.push_back({"SeqLock", p, results});
+    }
+
+    if (p.enable_seqlock_atomic)
+    {
+        using atomic_seqlock_solution_type = atomic_seqlock_solution<data_type, alignment_bytes>;
+        results = run_benchmark<atomic_seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                          p.block_size,
+                                                                                          p.num_readers,
+                                                                                          p.num_cycles,
+                                                                                          std::size_t{1},
+                                                                                          page_options{},
+                                                                                          p.sample_every,
+                                                                                          p.thread_placement);
+        m.push_back({"SeqLock atomic", p, results});
+
+        using simd_seqlock_solution_type = simd_seqlock_solution<data_type, alignment_bytes>;
+        results = run_benchmark<simd_seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                        p.block_size,
+                                                                                        p.num_readers,
+                                                                                        p.num_cycles,
+                                                                                        std::size_t{1},
+                                                                                        page_options{},
+                                                                                        p.sample_every,
+                                                                                        p.thread_placement);
+        m.push_back({"SeqLock SIMD", p, results});
+    }
+
+    if (p.enable_seqlock_streaming)
+    {
+        using streaming_seqlock_solution_type = streaming_seqlock_solution<data_type, alignment_bytes>;
+        results = run_benchmark<streaming_seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                             p.block_size,
+                                                                                             p.num_readers,
+                                                                                             p.num_cycles,
+                                                                                             std::size_t{1},
+                                                                                             page_options{},
+                                                                                             p.sample_every,
+                                                                                             p.thread_placement);
+        m.push_back({"SeqLock streaming", p, results});
+
+        using prefetch_seqlock_solution_type = prefetch_seqlock_solution<data_type, alignment_bytes>;
+        results = run_benchmark<prefetch_seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                            p.block_size,
+                                                                                            p.num_readers,
+                                                                                            p.num_cycles,
+                                                                                            std::size_t{1},
+                                                                                            page_options{},
+                                                                                            p.sample_every,
+                                                                                            p.thread_placement);
+        m.push_back({"SeqLock streaming prefetch", p, results});
+    }
+
+    if (p.enable_seqlock_fixed)
+    {
+        const auto run = [&]<typename solution>()
+        {
+            results = run_benchmark<solution, data_type, alignment_bytes>(p.num_blocks,
+                                                                          p.block_size,
+                                                                          p.num_readers,
+                                                                          p.num_cycles,
+                                                                          std::size_t{1},
+                                                                          page_options{},
+                                                                          p.sample_every,
+                                                                          p.thread_placement);
+        };
+        if (with_fixed_geometry<data_type, alignment_bytes>(p, run))
+        {
+            m.push_back({"SeqLock fixed geometry", p, results});
+        }
+        else
+        {
+            spdlog::info("No fixed geometry SeqLock compiled for {} blocks of {} elements", p.num_blocks, p.block_size);
+        }
+    }
+
+    if (p.enable_seqlock_layouts)
+    {
+        using inline_seqlock_solution_type = inline_seqlock_solution<data_type, alignment_bytes>;
+        results = run_benchmark<inline_seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                          p.block_size,
+                                                                                          p.num_readers,
+                                                                                          p.num_cycles,
+                                                                                          std::size_t{1},
+                                                                                          page_options{},
+                                                                                          p.sample_every,
+                                                                                          p.thread_placement);
+        m.push_back({"SeqLock inline sequences", p, results});
+
+        using global_seqlock_solution_type = global_seqlock_solution<data_type, alignment_bytes>;
+        results = run_benchmark<global_seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                          p.block_size,
+                                                                                          p.num_readers,
+                                                                                          p.num_cycles,
+                                                                                          std::size_t{1},
+                                                                                          page_options{},
+                                                                                          p.sample_every,
+                                                                                          p.thread_placement);
+        m.push_back({"SeqLock global sequence", p, results});
+    }
+
+    if (p.enable_seqlock_view)
+    {
+        using seqlock_solution_type = seqlock_solution<data_type, alignment_bytes>;
+        results = run_benchmark<seqlock_solution_type, data_type, alignment_bytes, read_mode::copy_reduce>(p.num_blocks,
+                                                                                                          p.block_size,
+                                                                                                          p.num_readers,
+                                                                                                          p.num_cycles,
+                                                                                                          std::size_t{1},
+                                                                                                          page_options{},
+                                                                                                          p.sample_every,
+                                                                                                          p.thread_placement);
+        m.push_back({"SeqLock copy reduce", p, results});
+
+        results = run_benchmark<seqlock_solution_type, data_type, alignment_bytes, read_mode::view_reduce>(p.num_blocks,
+                                                                                                          p.block_size,
+                                                                                                          p.num_readers,
+                                                                                                          p.num_cycles,
+                                                                                                          std::size_t{1},
+                                                                                                          page_options{},
+                                                                                                          p.sample_every,
+                                                                                                          p.thread_placement);
+        m.push_back({"SeqLock view reduce", p, results});
+    }
+
+    if (p.enable_seqlock_sequenced)
+    {
+        using seqlock_solution_type = seqlock_solution<data_type, alignment_bytes>;
+        results = run_sequenced_benchmark<seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                             p.block_size,
+                                                                                             p.num_readers,
+                                                                                             p.num_cycles,
+                                                                                             p.sample_every);
+        m.push_back({"SeqLock sequenced", p, results});
     }
 
     if (p.enable_shared_lock)
@@ -83,8 +438,12 @@ std::string run_benchmark(const parameters &p)
         results = run_benchmark<shared_solution_type, data_type, alignment_bytes>(p.num_blocks,
                                                                                   p.block_size,
                                                                                   p.num_readers,
-                                                                                  p.num_cycles);
-        s += print_results("Shared mutex", p, results, ',');
+                                                                                  p.num_cycles,
+                                                                                  std::size_t{1},
+                                                                                  page_options{},
+                                                                                  p.sample_every,
+                                                                                  p.thread_placement);
+        m.push_back({"Shared mutex", p, results});
     }
 
     if (p.enable_mutex_lock)
@@ -93,52 +452,955 @@ std::string run_benchmark(const parameters &p)
         results = run_benchmark<exclusive_solution_type, data_type, alignment_bytes>(p.num_blocks,
                                                                                      p.block_size,
                                                                                      p.num_readers,
-                                                                                     p.num_cycles);
-        s += print_results("Mutex", p, results, ',');
+                                                                                     p.num_cycles,
+                                                                                     std::size_t{1},
+                                                                                     page_options{},
+                                                                                     p.sample_every,
+                                                                                     p.thread_placement);
+        m.push_back({"Mutex", p, results});
     }
 
+    if (p.enable_left_right)
+    {
+        using left_right_solution_type = left_right_solution<data_type, alignment_bytes>;
+        results = run_benchmark<left_right_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                      p.block_size,
+                                                                                      p.num_readers,
+                                                                                      p.num_cycles,
+                                                                                      std::size_t{1},
+                                                                                      page_options{},
+                                                                                      p.sample_every,
+                                                                                      p.thread_placement);
+        m.push_back({"Left-Right", p, results});
+    }
+
+    if (p.enable_mailbox)
+    {
+        using mailbox_solution_type = mailbox_solution<data_type, alignment_bytes>;
+        results = run_benchmark<mailbox_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                   p.block_size,
+                                                                                   p.num_readers,
+                                                                                   p.num_cycles,
+                                                                                   std::size_t{1},
+                                                                                   page_options{},
+                                                                                   p.sample_every,
+                                                                                   p.thread_placement);
+        m.push_back({"Mailbox", p, results});
+    }
+
+    if (p.enable_mpmc)
+    {
+        using mpmc_solution_type = mpmc_solution<data_type, alignment_bytes>;
+        results = run_benchmark<mpmc_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                p.block_size,
+                                                                                p.num_readers,
+                                                                                p.num_cycles,
+                                                                                std::size_t{1},
+                                                                                page_options{},
+                                                                                p.sample_every,
+                                                                                p.thread_placement);
+        m.push_back({"MPMC", p, results});
+    }
+
+    if (p.enable_variable)
+    {
+        frame_distribution frames = p.frames;
+        frames.max_size = p.block_size;
+        frames.min_size = std::clamp<std::size_t>(frames.min_size, 1, p.block_size);
+        results = run_variable_benchmark<data_type, alignment_bytes>(p.num_blocks,
+                                                                     frames,
+                                                                     p.num_readers,
+                                                                     p.num_cycles,
+                                                                     p.sample_every);
+        m.push_back({fmt::format("Variable {}", frames.name()), p, results});
+    }
+
+#if defined(__linux__)
+    if (p.enable_shm)
+    {
+        results = run_shm_benchmark<data_type, alignment_bytes>(p.num_blocks,
+                                                                p.block_size,
+                                                                p.num_readers,
+                                                                p.num_cycles,
+                                                                p.sample_every);
+        m.push_back({"SeqLock shm (processes)", p, results});
+    }
+#endif
+
     if (p.enable_zmq)
     {
-        parameters p_zmq = p;
-        p_zmq.num_cycles = 100;
-        results = run_zmq_benchmark<data_type, alignment_bytes>(p_zmq.block_size,
-                                                                p_zmq.num_readers,
-                                                                p_zmq.num_cycles);
+        for (const auto transport : p.zmq_transports)
+        {
+            const zmq_options options{transport, p.zmq_high_water_mark, p.zmq_conflate};
+            results = run_zmq_benchmark<data_type, alignment_bytes>(p.num_blocks,
+                                                                    p.block_size,
+                                                                    p.num_readers,
+                                                                    p.num_cycles,
+                                                                    p.sample_every,
+                                                                    p.thread_placement,
+                                                                    options);
+            m.push_back({zmq_name(options), p, results});
+        }
+    }
+
+    return m;
+}
+
+/// @brief Consumer wait strategies of the SeqLock, with the writer publishing a block every p.wait_interval_ns
+template <typename data_type>
+std::vector<measurement> run_wait_strategies_benchmark(const parameters &p)
+{
+    constexpr std::size_t alignment_bytes{16};
+
+    std::vector<measurement> m;
+    if constexpr (std::is_integral_v<data_type> && sizeof(data_type) == sizeof(std::uint64_t))
+    {
+        m.push_back(run_wait_strategy<seqlock_solution<data_type, alignment_bytes, memcpy_copy, busy_spin>, data_type>(p));
+        m.push_back(run_wait_strategy<seqlock_solution<data_type, alignment_bytes, memcpy_copy, spin_yield<>>, data_type>(p));
+        m.push_back(run_wait_strategy<seqlock_solution<data_type, alignment_bytes, memcpy_copy, futex_park<>>, data_type>(p));
+    }
+    else
+    {
+        spdlog::warn("Wait strategies carry a 64-bit timestamp in each block, skipped for {}", p.data_type);
+    }
+    return m;
+}
+
+/// @brief Soft real-time run: the writer releases a block every block_size / p.sample_rate seconds
+/// and every reader must have consumed it within p.deadline_fraction of a period
+template <typename data_type>
+std::vector<measurement> run_paced_benchmark(const parameters &p)
+{
+    std::vector<measurement> m;
+
+    constexpr std::size_t alignment_bytes{16};
+
+    paced_options options;
+    options.sample_rate = p.sample_rate;
+    options.jitter_ns = p.paced_jitter_ns;
+    options.deadline_fraction = p.deadline_fraction;
+    options.duration = p.throughput_duration;
+
+    benchmark_results results;
+
+    if (p.enable_seqlock)
+    {
+        using seqlock_solution_type = seqlock_solution<data_type, alignment_bytes>;
+        results = run_paced_benchmark<seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks, p.block_size, p.num_readers, options);
+        m.push_back({"SeqLock paced", p, results});
+    }
+
+    if (p.enable_seqlock_atomic)
+    {
+        using atomic_seqlock_solution_type = atomic_seqlock_solution<data_type, alignment_bytes>;
+        results = run_paced_benchmark<atomic_seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks, p.block_size, p.num_readers, options);
+        m.push_back({"SeqLock atomic paced", p, results});
+    }
+
+    if (p.enable_shared_lock)
+    {
+        using shared_solution_type = shared_solution<data_type, alignment_bytes>;
+        results = run_paced_benchmark<shared_solution_type, data_type, alignment_bytes>(p.num_blocks, p.block_size, p.num_readers, options);
+        m.push_back({"Shared mutex paced", p, results});
+    }
+
+    if (p.enable_mutex_lock)
+    {
+        using exclusive_solution_type = exclusive_solution<data_type, alignment_bytes>;
+        results = run_paced_benchmark<exclusive_solution_type, data_type, alignment_bytes>(p.num_blocks, p.block_size, p.num_readers, options);
+        m.push_back({"Mutex paced", p, results});
+    }
+
+    if (p.enable_left_right)
+    {
+        using left_right_solution_type = left_right_solution<data_type, alignment_bytes>;
+        results = run_paced_benchmark<left_right_solution_type, data_type, alignment_bytes>(p.num_blocks, p.block_size, p.num_readers, options);
+        m.push_back({"Left-Right paced", p, results});
+    }
 
-        s += print_results("ZMQ", p, results, ',');
+    if (p.enable_mpmc)
+    {
+        using mpmc_solution_type = mpmc_solution<data_type, alignment_bytes>;
+        results = run_paced_benchmark<mpmc_solution_type, data_type, alignment_bytes>(p.num_blocks, p.block_size, p.num_readers, options);
+        m.push_back({"MPMC paced", p, results});
     }
 
+    return m;
+}
+
+/// @brief p.num_readers SeqLock consumers as coroutines on p.coroutine_threads scheduler threads,
+/// against the same number of consumers with a thread each
+template <typename data_type>
+std::vector<measurement> run_coroutine_benchmark(const parameters &p)
+{
+    std::vector<measurement> m;
+
+    constexpr std::size_t alignment_bytes{16};
+    using seqlock_solution_type = seqlock_solution<data_type, alignment_bytes>;
+
+    benchmark_results results;
+
+    results = run_sequenced_benchmark<seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks, p.block_size, p.num_readers, p.num_cycles);
+    m.push_back({"SeqLock sequenced threads", p, results});
+
+    results = run_coroutine_benchmark<seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                         p.block_size,
+                                                                                         p.num_readers,
+                                                                                         p.num_cycles,
+                                                                                         p.coroutine_threads);
+    m.push_back({"SeqLock coroutines", p, results});
+
+    return m;
+}
+
+/// @brief Blocks of p.block_size frames of p.num_channels samples, stored interleaved and planar,
+/// with every reader consuming a single channel
+template <typename data_type>
+std::vector<measurement> run_channels_benchmark(const parameters &p)
+{
+    std::vector<measurement> m;
+
+    constexpr std::size_t alignment_bytes{16};
+    using interleaved_solution_type = channel_seqlock_solution<data_type, alignment_bytes, channel_layout::interleaved>;
+    using planar_solution_type = channel_seqlock_solution<data_type, alignment_bytes, channel_layout::planar>;
+
+    benchmark_results results;
+
+    results = run_channel_benchmark<interleaved_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                           p.block_size,
+                                                                                           p.num_channels,
+                                                                                           p.num_readers,
+                                                                                           p.num_cycles,
+                                                                                           p.sample_every);
+    m.push_back({"SeqLock interleaved channels", p, results});
+
+    results = run_channel_benchmark<planar_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                      p.block_size,
+                                                                                      p.num_channels,
+                                                                                      p.num_readers,
+                                                                                      p.num_cycles,
+                                                                                      p.sample_every);
+    m.push_back({"SeqLock planar channels", p, results});
+
+    return m;
+}
+
+/// @brief The graph of stages p.pipeline, each stage reading SeqLock rings and writing its own
+template <typename data_type>
+std::vector<measurement> run_pipeline_benchmark(const parameters &p)
+{
+    std::vector<measurement> m;
+
+    constexpr std::size_t alignment_bytes{16};
+    using seqlock_solution_type = seqlock_solution<data_type, alignment_bytes>;
+
+    if constexpr (std::is_integral_v<data_type> && sizeof(data_type) == sizeof(std::uint64_t))
+    {
+        pipeline_options options;
+        options.period_ns = p.pipeline_period_ns;
+        const benchmark_results results = run_pipeline_benchmark<seqlock_solution_type, data_type, alignment_bytes>(pipeline_config::parse(p.pipeline),
+                                                                                                                  p.num_blocks,
+                                                                                                                  p.block_size,
+                                                                                                                  p.num_cycles,
+                                                                                                                  options);
+        m.push_back({"SeqLock pipeline", p, results});
+    }
+    else
+    {
+        spdlog::warn("Pipelines carry the source block number in each block, skipped for {}", p.data_type);
+    }
+
+    return m;
+}
+
+/// @brief Solutions that can move several consecutive blocks per operation, with p.batch_size blocks per operation
+template <typename data_type>
+std::vector<measurement> run_batch_benchmark(const parameters &p)
+{
+    std::vector<measurement> m;
+
+    constexpr std::size_t alignment_bytes{16};
+
+    benchmark_results results;
+
+    if (p.enable_seqlock)
+    {
+        using seqlock_solution_type = seqlock_solution<data_type, alignment_bytes>;
+        results = run_benchmark<seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                   p.block_size,
+                                                                                   p.num_readers,
+                                                                                   p.num_cycles,
+                                                                                   p.batch_size,
+                                                                                   page_options{},
+                                                                                   p.sample_every,
+                                                                                   p.thread_placement);
+        m.push_back({"SeqLock batch", p, results});
+    }
+
+    if (p.enable_shared_lock)
+    {
+        using shared_solution_type = shared_solution<data_type, alignment_bytes>;
+        results = run_benchmark<shared_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                  p.block_size,
+                                                                                  p.num_readers,
+                                                                                  p.num_cycles,
+                                                                                  p.batch_size,
+                                                                                  page_options{},
+                                                                                  p.sample_every,
+                                                                                  p.thread_placement);
+        m.push_back({"Shared mutex batch", p, results});
+    }
+
+    if (p.enable_mutex_lock)
+    {
+        using exclusive_solution_type = exclusive_solution<data_type, alignment_bytes>;
+        results = run_benchmark<exclusive_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                     p.block_size,
+                                                                                     p.num_readers,
+                                                                                     p.num_cycles,
+                                                                                     p.batch_size,
+                                                                                     page_options{},
+                                                                                     p.sample_every,
+                                                                                     p.thread_placement);
+        m.push_back({"Mutex batch", p, results});
+    }
+
+    return m;
+}
+
+/// @brief Ring storage on the page backend selected in p.pages
+template <typename data_type>
+std::vector<measurement> run_pages_benchmark(const parameters &p)
+{
+    std::vector<measurement> m;
+
+    constexpr std::size_t alignment_bytes{16};
+
+    benchmark_results results;
+    const std::string suffix = fmt::format("{}{}", to_string(p.pages.backend), p.pages.prefault ? ", prefaulted" : "");
+
+    if (p.enable_memcpy)
+    {
+        using memcpy_solution_type = memcpy_solution<data_type, alignment_bytes>;
+        results = run_benchmark<memcpy_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                  p.block_size,
+                                                                                  p.num_readers,
+                                                                                  p.num_cycles,
+                                                                                  1,
+                                                                                  p.pages,
+                                                                                  p.sample_every,
+                                                                                  p.thread_placement);
+        m.push_back({fmt::format("Memcpy ({})", suffix), p, results});
+    }
+
+    if (p.enable_seqlock)
+    {
+        using seqlock_solution_type = seqlock_solution<data_type, alignment_bytes>;
+        results = run_benchmark<seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                   p.block_size,
+                                                                                   p.num_readers,
+                                                                                   p.num_cycles,
+                                                                                   1,
+                                                                                   p.pages,
+                                                                                   p.sample_every,
+                                                                                   p.thread_placement);
+        m.push_back({fmt::format("SeqLock ({})", suffix), p, results});
+    }
+
+    if (p.enable_shared_lock)
+    {
+        using shared_solution_type = shared_solution<data_type, alignment_bytes>;
+        results = run_benchmark<shared_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                  p.block_size,
+                                                                                  p.num_readers,
+                                                                                  p.num_cycles,
+                                                                                  1,
+                                                                                  p.pages,
+                                                                                  p.sample_every,
+                                                                                  p.thread_placement);
+        m.push_back({fmt::format("Shared mutex ({})", suffix), p, results});
+    }
+
+    return m;
+}
+
+/// @brief Sustained rate of every implementation for p.throughput_duration with every reader consuming every block
+template <typename data_type>
+std::vector<measurement> run_throughput_benchmark(const parameters &p)
+{
+    std::vector<measurement> m;
+
+    constexpr std::size_t alignment_bytes{16};
+
+    benchmark_results results;
+
+    if (p.enable_memcpy)
+    {
+        using memcpy_solution_type = memcpy_solution<data_type, alignment_bytes>;
+        results = run_throughput_benchmark<memcpy_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                             p.block_size,
+                                                                                             p.num_readers,
+                                                                                             p.throughput_duration);
+        m.push_back({"Memcpy throughput", p, results});
+    }
+
+    if (p.enable_seqlock)
+    {
+        using seqlock_solution_type = seqlock_solution<data_type, alignment_bytes>;
+        results = run_throughput_benchmark<seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                              p.block_size,
+                                                                                              p.num_readers,
+                                                                                              p.throughput_duration);
+        m.push_back({"SeqLock throughput", p, results});
+    }
+
+    if (p.enable_seqlock_atomic)
+    {
+        using atomic_seqlock_solution_type = atomic_seqlock_solution<data_type, alignment_bytes>;
+        results = run_throughput_benchmark<atomic_seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                                     p.block_size,
+                                                                                                     p.num_readers,
+                                                                                                     p.throughput_duration);
+        m.push_back({"SeqLock atomic throughput", p, results});
+    }
+
+    if (p.enable_seqlock_streaming)
+    {
+        using streaming_seqlock_solution_type = streaming_seqlock_solution<data_type, alignment_bytes>;
+        results = run_throughput_benchmark<streaming_seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                                        p.block_size,
+                                                                                                        p.num_readers,
+                                                                                                        p.throughput_duration);
+        m.push_back({"SeqLock streaming throughput", p, results});
+
+        using prefetch_seqlock_solution_type = prefetch_seqlock_solution<data_type, alignment_bytes>;
+        results = run_throughput_benchmark<prefetch_seqlock_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                                       p.block_size,
+                                                                                                       p.num_readers,
+                                                                                                       p.throughput_duration);
+        m.push_back({"SeqLock streaming prefetch throughput", p, results});
+    }
+
+    if (p.enable_seqlock_fixed)
+    {
+        const auto run = [&]<typename solution>()
+        {
+            results = run_throughput_benchmark<solution, data_type, alignment_bytes>(p.num_blocks,
+                                                                                     p.block_size,
+                                                                                     p.num_readers,
+                                                                                     p.throughput_duration);
+        };
+        if (with_fixed_geometry<data_type, alignment_bytes>(p, run))
+        {
+            m.push_back({"SeqLock fixed geometry throughput", p, results});
+        }
+    }
+
+    if (p.enable_shared_lock)
+    {
+        using shared_solution_type = shared_solution<data_type, alignment_bytes>;
+        results = run_throughput_benchmark<shared_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                             p.block_size,
+                                                                                             p.num_readers,
+                                                                                             p.throughput_duration);
+        m.push_back({"Shared mutex throughput", p, results});
+    }
+
+    if (p.enable_mutex_lock)
+    {
+        using exclusive_solution_type = exclusive_solution<data_type, alignment_bytes>;
+        results = run_throughput_benchmark<exclusive_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                                p.block_size,
+                                                                                                p.num_readers,
+                                                                                                p.throughput_duration);
+        m.push_back({"Mutex throughput", p, results});
+    }
+
+    if (p.enable_left_right)
+    {
+        using left_right_solution_type = left_right_solution<data_type, alignment_bytes>;
+        results = run_throughput_benchmark<left_right_solution_type, data_type, alignment_bytes>(p.num_blocks,
+                                                                                                 p.block_size,
+                                                                                                 p.num_readers,
+                                                                                                 p.throughput_duration);
+        m.push_back({"Left-Right throughput", p, results});
+    }
+
+    if (p.enable_zmq)
+    {
+        for (const auto transport : p.zmq_transports)
+        {
+            const zmq_options options{transport, p.zmq_high_water_mark, p.zmq_conflate};
+            results = run_zmq_throughput_benchmark<data_type, alignment_bytes>(p.num_blocks,
+                                                                               p.block_size,
+                                                                               p.num_readers,
+                                                                               p.throughput_duration,
+                                                                               options);
+            m.push_back({zmq_name(options) + " throughput", p, results});
+        }
+    }
+
+    return m;
+}
+
+/// @brief Parameters of the discarded warm-up run: warmup_cycles operations, time-boxed runs shortened in proportion
+parameters warmup_parameters(const parameters &p)
+{
+    parameters warm = p;
+    warm.num_cycles = std::min(p.warmup_cycles, p.num_cycles);
+    const double fraction = static_cast<double>(warm.num_cycles) / static_cast<double>(std::max<std::size_t>(p.num_cycles, 1));
+    warm.throughput_duration = std::chrono::milliseconds(static_cast<std::int64_t>(static_cast<double>(p.throughput_duration.count()) * fraction) + 1);
+    return warm;
+}
+
+/// @brief Run `mode` for one configuration: an optional warm-up, then p.repetitions measured runs
+/// combined per implementation
+template <typename data_type>
+std::string run_mode(const std::string &mode, const parameters &p)
+{
+    const auto run = [&mode](const parameters &q) -> std::vector<measurement>
+    {
+        if (mode == "channels")
+        {
+            return run_channels_benchmark<data_type>(q);
+        }
+        if constexpr (!std::is_arithmetic_v<data_type> || sizeof(data_type) < sizeof(std::uint32_t))
+        {
+            spdlog::warn("The {} mode does not run {} payloads, only the channels mode does", mode, q.data_type);
+            return {};
+        }
+        else
+        {
+            if (mode == "latency")
+            {
+                return run_benchmark<data_type>(q);
+            }
+            if (mode == "batch")
+            {
+                return run_batch_benchmark<data_type>(q);
+            }
+            if (mode == "pages")
+            {
+                return run_pages_benchmark<data_type>(q);
+            }
+            if (mode == "wait")
+            {
+                return run_wait_strategies_benchmark<data_type>(q);
+            }
+            if (mode == "throughput")
+            {
+                return run_throughput_benchmark<data_type>(q);
+            }
+            if (mode == "paced")
+            {
+                return run_paced_benchmark<data_type>(q);
+            }
+            if (mode == "coroutines")
+            {
+                return run_coroutine_benchmark<data_type>(q);
+            }
+            if (mode == "pipeline")
+            {
+                return run_pipeline_benchmark<data_type>(q);
+            }
+        }
+        throw std::runtime_error("unknown mode: " + mode);
+    };
+
+    if (p.warmup_cycles > 0)
+    {
+        run(warmup_parameters(p));
+    }
+    std::vector<std::vector<measurement>> runs;
+    for (std::size_t k = 0; k < std::max<std::size_t>(p.repetitions, 1); ++k)
+    {
+        runs.push_back(run(p));
+    }
+
+    std::string s;
+    for (std::size_t k = 0; k < runs.front().size(); ++k)
+    {
+        std::vector<benchmark_results> same;
+        for (const auto &r : runs)
+        {
+            same.push_back(r[k].results);
+        }
+        s += print_results(runs.front()[k].name, runs.front()[k].params, combine_repetitions(same), ',');
+    }
     return s;
 }
 
+std::string run_mode(const std::string &mode, const parameters &p)
+{
+    if (p.data_type == "uint64")
+    {
+        return run_mode<std::uint64_t>(mode, p);
+    }
+    if (p.data_type == "uint32")
+    {
+        return run_mode<std::uint32_t>(mode, p);
+    }
+    if (p.data_type == "double")
+    {
+        return run_mode<double>(mode, p);
+    }
+    if (p.data_type == "float")
+    {
+        return run_mode<float>(mode, p);
+    }
+    if (p.data_type == "int16")
+    {
+        return run_mode<std::int16_t>(mode, p);
+    }
+    if (p.data_type == "sensor")
+    {
+        return run_mode<sensor_sample>(mode, p);
+    }
+    throw std::runtime_error("unsupported data type: " + p.data_type);
+}
+
 int main(int argc, char *argv[])
 {
+    cxxopts::Options options("benchmarks", "Benchmarks of single producer multiple consumer implementations");
+    options.add_options()
+        ("m,modes", "sweeps to run: latency, batch, pages, wait, throughput, paced, coroutines, channels, pipeline or all", cxxopts::value<std::string>()->default_value("all"))
+        ("i,implementations", "memcpy, seqlock, seqlock-atomic, seqlock-view, seqlock-streaming, seqlock-fixed, seqlock-layouts, seqlock-sequenced, shared-mutex, mutex, left-right, mailbox, mpmc, variable, shm, zmq or all",
+         cxxopts::value<std::string>()->default_value("all"))
+        ("b,block-sizes", "block sizes in elements, a list or range such as 16:16384:x2 (default depends on the mode)", cxxopts::value<std::string>())
+        ("n,num-blocks", "ring lengths in blocks", cxxopts::value<std::string>()->default_value("10"))
+        ("r,readers", "numbers of readers (default depends on the mode)", cxxopts::value<std::string>())
+        ("p,placements", "thread placements of the latency, batch and pages modes: none, compact, scatter, smt-siblings, cross-l3",
+         cxxopts::value<std::string>()->default_value("none"))
+        ("producers", "numbers of writers in the latency mode, more than one runs only multi-producer solutions",
+         cxxopts::value<std::string>()->default_value("1"))
+        ("t,data-types", "element types: uint32, uint64, float, double, and int16 or sensor (16 byte timestamped records) in the channels mode only. Default uint64, and float,int16,sensor in the channels mode", cxxopts::value<std::string>())
+        ("c,cycles", "operations per run", cxxopts::value<std::size_t>()->default_value("1000000"))
+        ("w,warmup-cycles", "operations of a discarded warm-up run before each configuration, 0 to skip", cxxopts::value<std::size_t>()->default_value("0"))
+        ("repetitions", "measured runs per configuration, reported with mean, stddev and 95% confidence interval", cxxopts::value<std::size_t>()->default_value("1"))
+        ("sample-every", "time one operation in N", cxxopts::value<std::size_t>()->default_value("1"))
+        ("batch-sizes", "blocks per operation in the batch mode", cxxopts::value<std::string>()->default_value("2,4,8"))
+        ("wait-intervals", "writer period in ns in the wait mode", cxxopts::value<std::string>()->default_value("1000,10000,100000"))
+        ("duration-ms", "length of each throughput and paced run", cxxopts::value<std::size_t>()->default_value("1000"))
+        ("sample-rates", "sample rates in Hz of the paced mode, the writer releases a block every block size / sample rate",
+         cxxopts::value<std::string>()->default_value("48000,96000,192000"))
+        ("jitter-ns", "random delay of up to this many ns added to every release in the paced mode", cxxopts::value<std::size_t>()->default_value("0"))
+        ("deadline-percent", "time readers have to consume a block after its release in the paced mode, in percent of the period",
+         cxxopts::value<std::size_t>()->default_value("100"))
+        ("channels", "samples per frame in the channels mode, block sizes count frames", cxxopts::value<std::string>()->default_value("2,8"))
+        ("pipelines", "graphs of the pipeline mode: stages separated by ';', each followed by the stages it reads as <-a+b, the first one is the source",
+         cxxopts::value<std::string>()->default_value("capture;filter<-capture;features<-filter;sink<-features,capture;left<-capture;right<-capture;sink<-left+right"))
+        ("pipeline-period-ns", "period of the pipeline source, 0 writes as fast as possible", cxxopts::value<std::size_t>()->default_value("0"))
+        ("coroutine-threads", "scheduler threads shared by the coroutine consumers in the coroutines mode",
+         cxxopts::value<std::size_t>()->default_value("1"))
+        ("zmq-transports", "ZeroMQ endpoints: inproc, ipc, tcp (loopback)", cxxopts::value<std::string>()->default_value("inproc,ipc,tcp"))
+        ("zmq-hwm", "ZeroMQ high water mark of the publisher and of every subscriber, in messages", cxxopts::value<int>()->default_value("1000"))
+        ("zmq-conflate", "ZeroMQ subscribers keep only the newest message")
+        ("perf-counters", "count cycles, instructions and cache misses of the writer and readers with perf_event_open (Linux)")
+        ("o,output", "results file", cxxopts::value<std::string>()->default_value("results.json"))
+        ("h,help", "print usage");
+
+    std::vector<std::string> modes;
+    std::vector<std::string> data_types;
+    std::vector<placement> placements;
+    std::vector<std::size_t> ring_lengths;
+    std::vector<std::size_t> batch_sizes;
+    std::vector<std::size_t> producers;
+    std::vector<std::size_t> wait_intervals_ns;
+    std::vector<std::size_t> sample_rates;
+    std::vector<std::size_t> channel_counts;
+    std::vector<pipeline_config> pipelines;
+    std::string output;
+    parameters p;
+    cxxopts::ParseResult args;
+    try
+    {
+        args = options.parse(argc, argv);
+        if (args.count("help") > 0)
+        {
+            fmt::print("{}\n", options.help());
+            return 0;
+        }
+        modes = sweep::split(args["modes"].as<std::string>());
+        if (sweep::selected(args["modes"].as<std::string>(), "all"))
+        {
+            modes = {"latency", "batch", "pages", "wait", "throughput", "paced", "coroutines", "channels", "pipeline"};
+        }
+        data_types = sweep::split(args.count("data-types") > 0 ? args["data-types"].as<std::string>() : std::string("uint64"));
+        channel_counts = sweep::parse_sizes(args["channels"].as<std::string>());
+        for (const auto &spec : sweep::split(args["pipelines"].as<std::string>()))
+        {
+            pipelines.push_back(pipeline_config::parse(spec));
+        }
+        p.pipeline_period_ns = args["pipeline-period-ns"].as<std::size_t>();
+        for (const auto &name : sweep::split(args["placements"].as<std::string>()))
+        {
+            placements.push_back(to_placement(name));
+        }
+        ring_lengths = sweep::parse_sizes(args["num-blocks"].as<std::string>());
+        batch_sizes = sweep::parse_sizes(args["batch-sizes"].as<std::string>());
+        producers = sweep::parse_sizes(args["producers"].as<std::string>());
+        wait_intervals_ns = sweep::parse_sizes(args["wait-intervals"].as<std::string>());
+        sample_rates = sweep::parse_sizes(args["sample-rates"].as<std::string>());
+        p.paced_jitter_ns = args["jitter-ns"].as<std::size_t>();
+        p.deadline_fraction = static_cast<double>(args["deadline-percent"].as<std::size_t>()) / 100.0;
+        p.coroutine_threads = std::max<std::size_t>(args["coroutine-threads"].as<std::size_t>(), 1);
+        output = args["output"].as<std::string>();
+
+        const std::string implementations = args["implementations"].as<std::string>();
+        p.enable_memcpy = sweep::selected(implementations, "memcpy");
+        p.enable_seqlock = sweep::selected(implementations, "seqlock");
+        p.enable_seqlock_atomic = sweep::selected(implementations, "seqlock-atomic");
+        p.enable_seqlock_view = sweep::selected(implementations, "seqlock-view");
+        p.enable_seqlock_streaming = sweep::selected(implementations, "seqlock-streaming");
+        p.enable_seqlock_fixed = sweep::selected(implementations, "seqlock-fixed");
+        p.enable_seqlock_layouts = sweep::selected(implementations, "seqlock-layouts");
+        p.enable_seqlock_sequenced = sweep::selected(implementations, "seqlock-sequenced");
+        p.enable_shared_lock = sweep::selected(implementations, "shared-mutex");
+        p.enable_mutex_lock = sweep::selected(implementations, "mutex");
+        p.enable_variable = sweep::selected(implementations, "variable");
+        p.enable_mpmc = sweep::selected(implementations, "mpmc");
+        p.enable_left_right = sweep::selected(implementations, "left-right");
+        p.enable_mailbox = sweep::selected(implementations, "mailbox");
+        p.enable_shm = sweep::selected(implementations, "shm");
+        p.enable_zmq = sweep::selected(implementations, "zmq");
+        p.num_cycles = args["cycles"].as<std::size_t>();
+        p.warmup_cycles = args["warmup-cycles"].as<std::size_t>();
+        p.repetitions = args["repetitions"].as<std::size_t>();
+        p.sample_every = args["sample-every"].as<std::size_t>();
+        p.throughput_duration = std::chrono::milliseconds(args["duration-ms"].as<std::size_t>());
+        perf_counters::enable(args.count("perf-counters") > 0);
+        p.zmq_transports.clear();
+        for (const auto &name : sweep::split(args["zmq-transports"].as<std::string>()))
+        {
+            p.zmq_transports.push_back(to_zmq_transport(name));
+        }
+        p.zmq_high_water_mark = args["zmq-hwm"].as<int>();
+        p.zmq_conflate = args.count("zmq-conflate") > 0;
+        if (p.num_cycles < 2)
+        {
+            throw std::runtime_error("at least two cycles are needed per run");
+        }
+    }
+    catch (const std::exception &e)
+    {
+        fmt::print(stderr, "{}\n{}\n", e.what(), options.help());
+        return 1;
+    }
+
+    /// Block sizes and reader counts given on the command line apply to every mode, otherwise each mode has its own
+    const auto axis = [&args](const char *name, const char *fallback)
+    {
+        return sweep::parse_sizes(args.count(name) > 0 ? args[name].as<std::string>() : std::string(fallback));
+    };
+    constexpr page_options page_configurations[] = {{page_backend::heap, true},
+                                                    {page_backend::mmap, false},
+                                                    {page_backend::mmap, true},
+                                                    {page_backend::huge_pages, false},
+                                                    {page_backend::huge_pages, true}};
+
     std::shared_ptr<spdlog::logger> file_logger = spdlog::rotating_logger_mt("benchmark", "benchmark.log", 1048576 * 5, 3);
     file_logger->set_pattern("[%Y-%m-%d %H:%M:%S.%e %z] [%-8t] [%-8l] %v");
     file_logger->set_level(spdlog::level::debug);
     spdlog::set_default_logger(file_logger);
 
-    constexpr std::size_t block_sizes[] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384};
-    constexpr std::size_t readers[] = {1, 2, 3, 4, 5};
-    parameters p;
     std::string s = "{ \"results\": [\n";
-
-    for (const auto &b : block_sizes)
+    // a configuration that fails is logged and skipped, so a long sweep keeps what it has measured
+    std::size_t failed_configurations{0};
+    const auto run_configuration = [&failed_configurations](const std::string &mode, const parameters &q) -> std::string
+    {
+        try
+        {
+            return run_mode(mode, q);
+        }
+        catch (const std::exception &e)
+        {
+            ++failed_configurations;
+            const std::string configuration = fmt::format("{} mode, {}, block size {}, {} blocks, {} readers",
+                                                          mode, q.data_type, q.block_size, q.num_blocks, q.num_readers);
+            spdlog::error("benchmark failed ({}): {}", configuration, e.what());
+            fmt::print(stderr, "benchmark failed ({}): {}\n", configuration, e.what());
+            return {};
+        }
+    };
+    try
     {
-        for (const auto &r : readers)
+        for (const auto &where : placements)
         {
-            p.block_size = b;
-            p.num_readers = r;
-            s += run_benchmark(p);
+            p.thread_placement = where;
+            for (const auto &data_type : data_types)
+            {
+                p.data_type = data_type;
+                for (const auto &n : ring_lengths)
+                {
+                    p.num_blocks = n;
+                    for (const auto &mode : modes)
+                    {
+                        if (mode == "latency")
+                        {
+                            for (const auto &b : axis("block-sizes", "16:16384:x2"))
+                            {
+                                for (const auto &r : axis("readers", "1:5"))
+                                {
+                                    for (const auto &w : producers)
+                                    {
+                                        p.block_size = b;
+                                        p.num_readers = r;
+                                        p.num_writers = w;
+                                        s += run_configuration(mode, p);
+                                    }
+                                }
+                            }
+                            p.num_writers = 1;
+                        }
+                        else if (mode == "batch")
+                        {
+                            for (const auto &b : axis("block-sizes", "16:128:x2"))
+                            {
+                                for (const auto &batch : batch_sizes)
+                                {
+                                    if (batch > n)
+                                    {
+                                        continue;
+                                    }
+                                    p.block_size = b;
+                                    p.batch_size = batch;
+                                    p.num_readers = axis("readers", "3").front();
+                                    s += run_configuration(mode, p);
+                                }
+                            }
+                            p.batch_size = 1;
+                        }
+                        else if (mode == "pages")
+                        {
+                            for (const auto &b : axis("block-sizes", "4096:16384:x2"))
+                            {
+                                for (const auto &pages : page_configurations)
+                                {
+                                    p.block_size = b;
+                                    p.pages = pages;
+                                    p.num_readers = axis("readers", "3").front();
+                                    s += run_configuration(mode, p);
+                                }
+                            }
+                            p.pages = {};
+                        }
+                        else if (mode == "wait")
+                        {
+                            for (const auto &interval : wait_intervals_ns)
+                            {
+                                for (const auto &r : axis("readers", "1:5"))
+                                {
+                                    p.block_size = axis("block-sizes", "64").front();
+                                    p.num_readers = r;
+                                    p.wait_interval_ns = interval;
+                                    p.wait_cycles = 1000000000 / std::max<std::size_t>(interval, 1); // one second per strategy
+                                    s += run_configuration(mode, p);
+                                }
+                            }
+                        }
+                        else if (mode == "paced")
+                        {
+                            for (const auto &rate : sample_rates)
+                            {
+                                for (const auto &b : axis("block-sizes", "64,256,1024"))
+                                {
+                                    for (const auto &r : axis("readers", "1,3"))
+                                    {
+                                        p.sample_rate = static_cast<double>(rate);
+                                        p.block_size = b;
+                                        p.num_readers = r;
+                                        s += run_configuration(mode, p);
+                                    }
+                                }
+                            }
+                        }
+                        else if (mode == "coroutines")
+                        {
+                            for (const auto &b : axis("block-sizes", "64,1024"))
+                            {
+                                for (const auto &r : axis("readers", "1:64:x2"))
+                                {
+                                    p.block_size = b;
+                                    p.num_readers = r;
+                                    s += run_configuration(mode, p);
+                                }
+                            }
+                        }
+                        else if (mode == "channels")
+                        {
+                            // payloads of their own unless the data types were given
+                            const std::vector<std::string> payloads = args.count("data-types") > 0 ? std::vector<std::string>{data_type}
+                                                                                                   : sweep::split("float,int16,sensor");
+                            for (const auto &payload : payloads)
+                            {
+                                for (const auto &channels : channel_counts)
+                                {
+                                    for (const auto &b : axis("block-sizes", "64,256,1024"))
+                                    {
+                                        for (const auto &r : axis("readers", "1,3"))
+                                        {
+                                            p.data_type = payload;
+                                            p.num_channels = channels;
+                                            p.block_size = b;
+                                            p.num_readers = r;
+                                            s += run_configuration(mode, p);
+                                        }
+                                    }
+                                }
+                            }
+                            p.data_type = data_type;
+                        }
+                        else if (mode == "pipeline")
+                        {
+                            for (const auto &pipeline : pipelines)
+                            {
+                                for (const auto &b : axis("block-sizes", "64,1024"))
+                                {
+                                    p.pipeline = pipeline.spec;
+                                    p.block_size = b;
+                                    p.num_readers = pipeline.stages.size() - 1;
+                                    s += run_configuration(mode, p);
+                                }
+                            }
+                        }
+                        else if (mode == "throughput")
+                        {
+                            for (const auto &b : axis("block-sizes", "16,256,4096,16384"))
+                            {
+                                for (const auto &r : axis("readers", "1,3,5"))
+                                {
+                                    p.block_size = b;
+                                    p.num_readers = r;
+                                    s += run_configuration(mode, p);
+                                }
+                            }
+                        }
+                        else
+                        {
+                            throw std::runtime_error("unknown mode: " + mode);
+                        }
+                    }
+                }
+            }
         }
     }
-    s[s.size() - 2] = ' ';
+    catch (const std::exception &e)
+    {
+        // still write the results gathered so far
+        ++failed_configurations;
+        spdlog::error("benchmark failed: {}", e.what());
+        fmt::print(stderr, "benchmark failed: {}\n", e.what());
+    }
+    if (s.size() > 2 && s[s.size() - 2] == ',')
+    {
+        s[s.size() - 2] = ' ';
+    }
     s += "]\n}";
 
-    std::ofstream fo("results.json");
+    std::ofstream fo(output);
     fo << s << "\n";
 
     file_logger->flush();
     spdlog::shutdown();
-    return 0;
-}
\ No newline at end of file
+    return failed_configurations > 0 ? 1 : 0;
+}
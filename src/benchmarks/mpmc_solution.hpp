@@ -0,0 +1,164 @@
+#pragma once
+
+#include "aligned_array.hpp"
+#include "atomic_copy.hpp"
+#include "consumer.hpp"
+#include "seqlock_solution.hpp"
+#include "wait_strategy.hpp"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+/// @brief Ring shared by several producers and several consumers. A producer claims the next
+/// global sequence number with a fetch-add, waits until the previous occupant of its slot has
+/// been written, copies its block under the slot's SeqLock sequence and then commits in claim
+/// order: `published` only moves past block k once blocks 0..k are all written, so consumers
+/// following the sequence never see a block before it is complete. Consumers can be lapped
+/// exactly as with seqlock_solution
+template <typename data_type, std::size_t alignment_bytes, typename copy_policy = memcpy_copy>
+class mpmc_solution
+{
+    std::size_t n_blocks;
+    std::size_t b_size;
+    std::vector<cursor<>> cursors;
+    cursor<> claimed;
+    cursor<> published;
+    aligned_array<data_type, alignment_bytes> a;
+
+public:
+    static constexpr bool multi_producer = true;
+
+    mpmc_solution(std::size_t num_blocks, std::size_t block_size, const page_options &pages = {})
+        : n_blocks(num_blocks),
+          b_size(block_size),
+          cursors(num_blocks),
+          claimed{0},
+          published{0},
+          a(num_blocks * block_size, pages)
+    {
+    }
+    ~mpmc_solution() = default;
+
+    [[nodiscard]] auto size() noexcept -> std::size_t { return n_blocks * b_size; }
+    [[nodiscard]] auto backend() const noexcept -> page_backend { return a.backend(); }
+
+    /// @brief Number of blocks committed so far. Block k of the global sequence is stored at index k % n_blocks
+    [[nodiscard]] auto head() const noexcept -> std::size_t { return published.seq.load(std::memory_order_acquire); }
+
+    void fill(data_type value)
+    {
+        fill_array(a, value);
+    }
+
+    void write(const data_type *src, std::size_t size)
+    {
+        if (src != nullptr && size == b_size)
+        {
+            const std::size_t claim = claimed.seq.fetch_add(1, std::memory_order_relaxed);
+            const std::size_t index = claim % n_blocks;
+            auto &seq = cursors[index].seq;
+
+            // the k-th write into a block leaves its sequence at 2k, so 2 * lap means the block is free
+            const std::size_t lap = claim / n_blocks;
+            spin_until([&seq, lap]
+                       { return seq.load(std::memory_order_acquire) == 2 * lap; });
+            seq.store(2 * lap + 1, std::memory_order_release);
+            copy_policy::write_fence();
+            copy_policy::store(a.offset(index * b_size), src, size);
+            std::atomic_signal_fence(std::memory_order_acq_rel);
+            seq.store(2 * lap + 2, std::memory_order_release);
+
+            spin_until([this, claim]
+                       { return published.seq.load(std::memory_order_acquire) == claim; });
+            published.seq.store(claim + 1, std::memory_order_release);
+            return;
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+
+    void read(data_type *dst, std::size_t size, std::size_t offset)
+    {
+        if (dst != nullptr && size == b_size)
+        {
+            const size_t index = offset / size;
+            std::size_t seq0;
+            std::size_t seq1;
+            do
+            {
+                seq0 = cursors[index].seq.load(std::memory_order_acquire);
+                std::atomic_signal_fence(std::memory_order_acq_rel);
+                copy_policy::load(dst, a.offset(offset), size);
+                copy_policy::read_fence();
+                seq1 = cursors[index].seq.load(std::memory_order_acquire);
+            } while (seq0 != seq1 || seq0 & 1);
+
+            return;
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+
+    /// @brief Read the oldest committed block the consumer has not seen yet, see seqlock_solution::read_next
+    auto read_next(data_type *dst, std::size_t size, consumer_cursor &consumer) -> read_result
+    {
+        if (dst != nullptr && size == b_size)
+        {
+            std::size_t lost{0};
+            while (true)
+            {
+                const std::size_t head_seq = published.seq.load(std::memory_order_acquire);
+                if (consumer.next >= head_seq)
+                {
+                    return {read_status::not_ready, lost};
+                }
+                if (head_seq - consumer.next > n_blocks)
+                {
+                    lost += head_seq - n_blocks - consumer.next;
+                    consumer.next = head_seq - n_blocks;
+                }
+
+                const std::size_t index = consumer.next % n_blocks;
+                const std::size_t expected = 2 * (consumer.next / n_blocks + 1);
+                const std::size_t seq0 = cursors[index].seq.load(std::memory_order_acquire);
+                if (seq0 == expected)
+                {
+                    std::atomic_signal_fence(std::memory_order_acq_rel);
+                    copy_policy::load(dst, a.offset(index * size), size);
+                    copy_policy::read_fence();
+                    if (cursors[index].seq.load(std::memory_order_acquire) == expected)
+                    {
+                        ++consumer.next;
+                        consumer.lost += lost;
+                        return {read_status::ok, lost};
+                    }
+                }
+                // a producer has lapped the consumer and is overwriting this block, catch up
+            }
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+};
+
+/// @brief Several producers on a single producer solution, serialised by one mutex around every write
+template <typename solution>
+class serialised_producers : public solution
+{
+    std::mutex producers;
+
+public:
+    static constexpr bool multi_producer = true;
+
+    using solution::solution;
+
+    template <typename data_type>
+    void write(const data_type *src, std::size_t size)
+    {
+        const std::lock_guard<std::mutex> lock(producers);
+        solution::write(src, size);
+    }
+
+    /// batches would bypass the producers' mutex
+    template <typename data_type>
+    void write_batch(const data_type *src, std::size_t size) = delete;
+};
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "aligned_array.hpp"
+#include "benchmark.hpp"
+#include "wait_benchmark.hpp"
+#include "wait_strategy.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <latch>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+/// Soft real-time producer: block k arrives at start + k * period, period = block_size / sample_rate,
+/// like an audio interface delivering a buffer every period. Each arrival is delayed by a random
+/// jitter of up to `jitter_ns`. Every consumer must be done with block k, read and summed, by
+/// arrival + `deadline_fraction` of a period, otherwise it has missed the deadline
+
+struct paced_options
+{
+    double sample_rate{48000.0};
+    std::uint64_t jitter_ns{0};
+    double deadline_fraction{1.0};  // consumer deadline after each arrival, in periods
+    std::uint64_t spin_ns{50000};   // the writer sleeps until this long before the arrival and spins the rest
+    std::chrono::nanoseconds duration{std::chrono::seconds(1)};
+
+    [[nodiscard]] auto period_ns(std::size_t block_size) const noexcept -> std::uint64_t
+    {
+        return static_cast<std::uint64_t>(static_cast<double>(block_size) * 1e9 / sample_rate);
+    }
+
+    [[nodiscard]] auto deadline_ns(std::size_t block_size) const noexcept -> std::uint64_t
+    {
+        return static_cast<std::uint64_t>(static_cast<double>(period_ns(block_size)) * deadline_fraction);
+    }
+};
+
+/// @brief Sleep until `deadline_ns` on the steady clock: an absolute clock_nanosleep to `spin_ns`
+/// before the deadline, which is immune to drift, then a spin for the remaining wake-up latency
+inline void sleep_until_ns(std::uint64_t deadline_ns, std::uint64_t spin_ns) noexcept
+{
+    if (deadline_ns > spin_ns && steady_now_ns() < deadline_ns - spin_ns)
+    {
+        const std::uint64_t wake = deadline_ns - spin_ns;
+#if defined(__linux__)
+        // std::chrono::steady_clock is CLOCK_MONOTONIC on Linux
+        timespec ts{static_cast<time_t>(wake / 1000000000ULL), static_cast<long>(wake % 1000000000ULL)};
+        while (::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) != 0)
+        {
+        }
+#else
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(wake)));
+#endif
+    }
+    while (steady_now_ns() < deadline_ns)
+    {
+        cpu_relax();
+    }
+}
+
+/// @brief Writer releasing one block per period. Block k carries k in every element; wake-up
+/// jitter is how late the writer woke for its target time, write latency the write itself
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void paced_producer(solution &store,
+                    std::size_t block_size,
+                    std::size_t cycles,
+                    const paced_options &options,
+                    std::atomic<std::uint64_t> &start_ns,
+                    progress_counter &written,
+                    std::latch &thread_latch,
+                    double &write_time_ns,
+                    latency_histogram &write_histogram,
+                    latency_histogram &wakeup_histogram)
+{
+    spdlog::info("Paced producer starts, sample rate {} Hz", options.sample_rate);
+
+    const std::uint64_t period = options.period_ns(block_size);
+    aligned_array<data_type, alignment_bytes> src(block_size);
+    std::mt19937_64 random(block_size);
+    std::uniform_int_distribution<std::uint64_t> jitter(0, options.jitter_ns);
+    thread_latch.arrive_and_wait();
+
+    const std::uint64_t start = steady_now_ns() + period;
+    start_ns.store(start, std::memory_order_release);
+    write_time_ns = 0;
+    for (std::size_t k = 0; k < cycles; ++k)
+    {
+        fill_array(src, static_cast<data_type>(k));
+        const std::uint64_t target = start + k * period + jitter(random);
+        sleep_until_ns(target, options.spin_ns);
+        const std::uint64_t t0 = steady_now_ns();
+        wakeup_histogram.record(t0 - target);
+        store.write(src.data(), block_size);
+        written.value.store(k + 1, std::memory_order_release);
+        const std::uint64_t ns = steady_now_ns() - t0;
+        write_time_ns += static_cast<double>(ns);
+        write_histogram.record(ns);
+    }
+
+    write_time_ns = cycles > 0 ? write_time_ns / cycles : 0.0;
+    spdlog::info("Paced producer terminates. Write time, ns: {:.1f}, worst wake-up jitter, ns: {}", write_time_ns, wakeup_histogram.max());
+}
+
+/// @brief What a consumer reports about its deadlines
+struct deadline_report
+{
+    std::size_t misses{0};
+    std::uint64_t worst_lateness_ns{0}; // zero if no deadline was missed
+};
+
+/// @brief Consumer reading every block as soon as it is written and summing it. The time from the
+/// block's nominal arrival to the end of the sum is its response time, recorded in the histogram.
+/// Blocks overwritten before the consumer got to them count as lost and as missed deadlines
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void deadline_consumer(solution &store,
+                       std::size_t num_blocks,
+                       std::size_t block_size,
+                       std::size_t cycles,
+                       const paced_options &options,
+                       std::size_t index,
+                       const std::atomic<std::uint64_t> &start_ns,
+                       const progress_counter &written,
+                       std::latch &thread_latch,
+                       double &response_time_ns,
+                       std::size_t &lost_blocks,
+                       deadline_report &report,
+                       latency_histogram &histogram)
+{
+    spdlog::info("Deadline consumer {} starts", index);
+
+    const std::uint64_t period = options.period_ns(block_size);
+    const std::uint64_t deadline = options.deadline_ns(block_size);
+    aligned_array<data_type, alignment_bytes> dst(block_size);
+    thread_latch.arrive_and_wait();
+
+    response_time_ns = 0;
+    lost_blocks = 0;
+    report = {};
+    data_type checksum{0};
+    for (std::size_t n = 0; n < cycles; ++n)
+    {
+        spin_until([&written, n]
+                   { return written.value.load(std::memory_order_acquire) > n; });
+        store.read(dst.data(), block_size, (n % num_blocks) * block_size);
+        checksum += std::accumulate(dst.data(), dst.data() + block_size, data_type{0});
+        const std::uint64_t done = steady_now_ns();
+
+        const std::uint64_t arrival = start_ns.load(std::memory_order_acquire) + n * period;
+        const std::uint64_t response = done > arrival ? done - arrival : 0;
+        response_time_ns += static_cast<double>(response);
+        histogram.record(response);
+        const bool overwritten = static_cast<std::size_t>(dst.data()[0]) != n;
+        lost_blocks += overwritten ? 1 : 0;
+        if (overwritten || response > deadline)
+        {
+            ++report.misses;
+            report.worst_lateness_ns = std::max(report.worst_lateness_ns, response > deadline ? response - deadline : 0);
+        }
+    }
+
+    response_time_ns = cycles > 0 ? response_time_ns / cycles : 0.0;
+    spdlog::info("Deadline consumer {} terminates. Response time, ns: {:.1f}, missed: {}, worst lateness, ns: {}, checksum: {}",
+                 index, response_time_ns, report.misses, report.worst_lateness_ns, checksum);
+}
+
+/// @brief Paced producer and deadline consumers for options.duration. Reader times are mean
+/// response times; misses, lateness and the writer's wake-up jitter are added as metrics
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+benchmark_results run_paced_benchmark(std::size_t num_blocks,
+                                      std::size_t block_size,
+                                      std::size_t num_readers,
+                                      const paced_options &options)
+{
+    solution store(num_blocks, block_size);
+    store.fill(data_type{0});
+
+    const std::uint64_t period = options.period_ns(block_size);
+    const std::size_t cycles = std::max<std::size_t>(static_cast<std::size_t>(options.duration.count()) / std::max<std::uint64_t>(period, 1), 1);
+
+    std::latch thread_latch(num_readers + 1);
+    benchmark_results results{std::vector<double>(num_readers + 1), std::vector<std::size_t>(num_readers)};
+    results.labels.emplace_back("clock_source", "steady_clock");
+    std::vector<double> &times = results.times;
+    std::atomic<std::uint64_t> start_ns{0};
+    progress_counter written;
+    latency_histogram wakeup;
+
+    std::thread writer_thread(paced_producer<solution, data_type, alignment_bytes>,
+                              std::ref(store),
+                              block_size,
+                              cycles,
+                              std::cref(options),
+                              std::ref(start_ns),
+                              std::ref(written),
+                              std::ref(thread_latch),
+                              std::ref(times[0]),
+                              std::ref(results.write_latency),
+                              std::ref(wakeup));
+
+    std::vector<latency_histogram> histograms(num_readers);
+    std::vector<deadline_report> reports(num_readers);
+    std::vector<std::thread> readers;
+    for (std::size_t k = 0; k < num_readers; ++k)
+    {
+        readers.emplace_back(deadline_consumer<solution, data_type, alignment_bytes>,
+                             std::ref(store),
+                             num_blocks,
+                             block_size,
+                             cycles,
+                             std::cref(options),
+                             k,
+                             std::cref(start_ns),
+                             std::cref(written),
+                             std::ref(thread_latch),
+                             std::ref(times[k + 1]),
+                             std::ref(results.lost[k]),
+                             std::ref(reports[k]),
+                             std::ref(histograms[k]));
+    }
+
+    writer_thread.join();
+    for (auto &r : readers)
+    {
+        r.join();
+    }
+    for (const auto &h : histograms)
+    {
+        results.read_latency.merge(h);
+    }
+
+    std::size_t misses{0};
+    std::uint64_t worst{0};
+    for (const auto &report : reports)
+    {
+        misses += report.misses;
+        worst = std::max(worst, report.worst_lateness_ns);
+    }
+    const double blocks = static_cast<double>(cycles * std::max<std::size_t>(num_readers, 1));
+    results.metrics.emplace_back("sample_rate", options.sample_rate);
+    results.metrics.emplace_back("period_ns", static_cast<double>(period));
+    results.metrics.emplace_back("deadline_ns", static_cast<double>(options.deadline_ns(block_size)));
+    results.metrics.emplace_back("jitter_ns", static_cast<double>(options.jitter_ns));
+    results.metrics.emplace_back("deadline_misses", static_cast<double>(misses));
+    results.metrics.emplace_back("deadline_miss_percent", 100.0 * static_cast<double>(misses) / blocks);
+    results.metrics.emplace_back("worst_lateness_ns", static_cast<double>(worst));
+    results.metrics.emplace_back("wakeup_jitter_p50_ns", static_cast<double>(wakeup.value_at_percentile(50.0)));
+    results.metrics.emplace_back("wakeup_jitter_p99_ns", static_cast<double>(wakeup.value_at_percentile(99.0)));
+    results.metrics.emplace_back("wakeup_jitter_max_ns", static_cast<double>(wakeup.max()));
+    return results;
+}
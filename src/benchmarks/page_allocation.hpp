@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <system_error>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#include <cerrno>
+#endif
+
+/// Page backends for aligned_array. Everything except `heap` needs Linux; on other
+/// platforms the allocation silently falls back to the heap and reports it
+
+enum class page_backend
+{
+    heap,                  // aligned operator new[], 4K pages faulted on first touch
+    mmap,                  // anonymous private mapping with regular pages
+    huge_pages,            // MAP_HUGETLB, falls back to transparent_huge_pages if none are reserved
+    transparent_huge_pages // 2M aligned mapping advised with MADV_HUGEPAGE
+};
+
+inline auto to_string(page_backend backend) -> std::string
+{
+    switch (backend)
+    {
+    case page_backend::heap:
+        return "heap";
+    case page_backend::mmap:
+        return "mmap";
+    case page_backend::huge_pages:
+        return "huge pages";
+    case page_backend::transparent_huge_pages:
+        return "transparent huge pages";
+    }
+    return "unknown";
+}
+
+struct page_options
+{
+    page_backend backend{page_backend::heap};
+    bool prefault{false}; // fault every page in at allocation time instead of on the first write
+    int numa_node{-1};    // bind the pages to this NUMA node with mbind, -1 keeps the default policy
+};
+
+/// @brief Memory obtained for a given set of page_options. `backend` is what was actually used
+struct page_allocation
+{
+    void *ptr{nullptr};
+    std::size_t bytes{0}; // size of the mapping, 0 for heap allocations
+    page_backend backend{page_backend::heap};
+};
+
+namespace page_memory
+{
+    inline constexpr std::size_t huge_page_bytes = std::size_t{2} << 20;
+
+    [[nodiscard]] constexpr auto round_up(std::size_t value, std::size_t multiple) noexcept -> std::size_t
+    {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    /// @brief Allocate `bytes` aligned to at least `alignment` bytes
+    [[nodiscard]] inline auto allocate(std::size_t bytes, std::size_t alignment, const page_options &options) -> page_allocation
+    {
+#if defined(__linux__)
+        const std::size_t page_bytes = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        if (options.backend != page_backend::heap && bytes > 0 && alignment <= page_bytes)
+        {
+            page_allocation result{nullptr, 0, options.backend};
+            const int populate = options.prefault && options.numa_node < 0 ? MAP_POPULATE : 0;
+
+            if (options.backend == page_backend::huge_pages)
+            {
+                result.bytes = round_up(bytes, huge_page_bytes);
+                void *p = ::mmap(nullptr, result.bytes, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+                result.ptr = p == MAP_FAILED ? nullptr : p;
+                if (result.ptr == nullptr)
+                {
+                    result.backend = page_backend::transparent_huge_pages;
+                }
+            }
+
+            if (result.backend == page_backend::transparent_huge_pages)
+            {
+                // over-allocate so the mapping can be trimmed to a 2M boundary
+                result.bytes = round_up(bytes, huge_page_bytes);
+                void *p = ::mmap(nullptr, result.bytes + huge_page_bytes, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (p == MAP_FAILED)
+                {
+                    throw std::system_error(errno, std::generic_category(), "mmap");
+                }
+                const auto base = reinterpret_cast<std::uintptr_t>(p);
+                const auto aligned = round_up(base, huge_page_bytes);
+                if (aligned > base)
+                {
+                    ::munmap(p, aligned - base);
+                }
+                if (aligned + result.bytes < base + result.bytes + huge_page_bytes)
+                {
+                    ::munmap(reinterpret_cast<void *>(aligned + result.bytes), base + huge_page_bytes - aligned);
+                }
+                result.ptr = reinterpret_cast<void *>(aligned);
+                ::madvise(result.ptr, result.bytes, MADV_HUGEPAGE);
+            }
+
+            if (result.backend == page_backend::mmap)
+            {
+                result.bytes = round_up(bytes, page_bytes);
+                void *p = ::mmap(nullptr, result.bytes, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS | populate, -1, 0);
+                if (p == MAP_FAILED)
+                {
+                    throw std::system_error(errno, std::generic_category(), "mmap");
+                }
+                result.ptr = p;
+            }
+
+            if (options.numa_node >= 0)
+            {
+                constexpr std::size_t mask_bits = 1024;
+                unsigned long mask[mask_bits / (8 * sizeof(unsigned long))] = {};
+                const auto node = static_cast<std::size_t>(options.numa_node);
+                if (node >= mask_bits)
+                {
+                    ::munmap(result.ptr, result.bytes);
+                    throw std::system_error(EINVAL, std::generic_category(), "mbind");
+                }
+                mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+                if (::syscall(SYS_mbind, result.ptr, result.bytes, MPOL_BIND, mask, mask_bits + 1, 0) != 0)
+                {
+                    const int error = errno;
+                    ::munmap(result.ptr, result.bytes);
+                    throw std::system_error(error, std::generic_category(), "mbind");
+                }
+            }
+
+            if (options.prefault && (populate == 0 || result.backend == page_backend::transparent_huge_pages))
+            {
+                auto *p = static_cast<volatile unsigned char *>(result.ptr);
+                for (std::size_t k = 0; k < result.bytes; k += page_bytes)
+                {
+                    p[k] = 0;
+                }
+            }
+            return result;
+        }
+#endif
+        void *p = ::operator new[](bytes, std::align_val_t{alignment});
+        if (options.prefault)
+        {
+            std::memset(p, 0, bytes);
+        }
+        return {p, 0, page_backend::heap};
+    }
+
+    inline void deallocate(const page_allocation &allocation, std::size_t alignment) noexcept
+    {
+        if (allocation.ptr == nullptr)
+        {
+            return;
+        }
+#if defined(__linux__)
+        if (allocation.backend != page_backend::heap)
+        {
+            ::munmap(allocation.ptr, allocation.bytes);
+            return;
+        }
+#endif
+        ::operator delete[](allocation.ptr, std::align_val_t{alignment});
+    }
+}
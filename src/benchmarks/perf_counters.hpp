@@ -0,0 +1,234 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/// Hardware performance counters of the calling thread through perf_event_open (Linux only).
+/// Every event is opened on its own, so a missing PMU event, a virtual machine without a PMU or
+/// a perf_event_paranoid setting that forbids counting only removes the events concerned.
+/// Counts are scaled by enabled / running time when the kernel multiplexes the counters.
+/// Cache-line transfers between sockets are approximated by the loads that miss the local NUMA
+/// node, the HITM events that count them exactly are model specific
+
+enum class perf_event : std::size_t
+{
+    cycles,
+    instructions,
+    l1d_misses,  // L1 data cache read misses
+    llc_misses,  // last level cache misses
+    node_misses, // loads served by a remote NUMA node
+    count
+};
+
+inline constexpr std::size_t perf_event_count = static_cast<std::size_t>(perf_event::count);
+
+inline auto to_string(perf_event event) -> const char *
+{
+    switch (event)
+    {
+    case perf_event::cycles:
+        return "cycles";
+    case perf_event::instructions:
+        return "instructions";
+    case perf_event::l1d_misses:
+        return "l1d_misses";
+    case perf_event::llc_misses:
+        return "llc_misses";
+    case perf_event::node_misses:
+        return "node_misses";
+    case perf_event::count:
+        break;
+    }
+    return "unknown";
+}
+
+/// @brief Counts of one thread or the sum over several, `valid` is false for events that could not be counted
+struct perf_counts
+{
+    std::array<double, perf_event_count> values{};
+    std::array<bool, perf_event_count> valid{};
+
+    [[nodiscard]] bool any() const noexcept
+    {
+        for (const bool v : valid)
+        {
+            if (v)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] auto operator[](perf_event event) const noexcept -> double
+    {
+        return values[static_cast<std::size_t>(event)];
+    }
+
+    /// @brief Sum with another thread's counts, an event stays valid only if both counted it
+    void add(const perf_counts &other) noexcept
+    {
+        for (std::size_t k = 0; k < perf_event_count; ++k)
+        {
+            values[k] += other.values[k];
+            valid[k] = valid[k] && other.valid[k];
+        }
+    }
+};
+
+class perf_counters
+{
+    std::array<int, perf_event_count> fds;
+
+    static auto enabled_flag() noexcept -> std::atomic<bool> &
+    {
+        static std::atomic<bool> on{false};
+        return on;
+    }
+
+#if defined(__linux__)
+    static auto open_event(perf_event event) noexcept -> int
+    {
+        constexpr auto cache = [](std::uint64_t id, std::uint64_t op, std::uint64_t result)
+        { return id | (op << 8) | (result << 16); };
+
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        switch (event)
+        {
+        case perf_event::cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case perf_event::instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case perf_event::l1d_misses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case perf_event::llc_misses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case perf_event::node_misses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache(PERF_COUNT_HW_CACHE_NODE, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case perf_event::count:
+            return -1;
+        }
+        // this thread, any CPU
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    }
+#endif
+
+public:
+    /// @brief Counters are only opened once enabled, see the --perf-counters option
+    static void enable(bool on) noexcept { enabled_flag().store(on); }
+    [[nodiscard]] static bool enabled() noexcept { return enabled_flag().load(); }
+
+    /// @brief Open the counters of the calling thread, stopped
+    perf_counters() noexcept
+    {
+        fds.fill(-1);
+#if defined(__linux__)
+        if (enabled())
+        {
+            for (std::size_t k = 0; k < perf_event_count; ++k)
+            {
+                fds[k] = open_event(static_cast<perf_event>(k));
+            }
+        }
+#endif
+    }
+
+    perf_counters(const perf_counters &) = delete;
+    perf_counters &operator=(const perf_counters &) = delete;
+
+    ~perf_counters()
+    {
+#if defined(__linux__)
+        for (const int fd : fds)
+        {
+            if (fd >= 0)
+            {
+                ::close(fd);
+            }
+        }
+#endif
+    }
+
+    [[nodiscard]] bool available() const noexcept
+    {
+        for (const int fd : fds)
+        {
+            if (fd >= 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void start() noexcept
+    {
+#if defined(__linux__)
+        for (const int fd : fds)
+        {
+            if (fd >= 0)
+            {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    void stop() noexcept
+    {
+#if defined(__linux__)
+        for (const int fd : fds)
+        {
+            if (fd >= 0)
+            {
+                ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+#endif
+    }
+
+    /// @brief Counts since start(), scaled for multiplexing. An event that never ran is not valid
+    [[nodiscard]] auto read() const noexcept -> perf_counts
+    {
+        perf_counts counts;
+#if defined(__linux__)
+        for (std::size_t k = 0; k < perf_event_count; ++k)
+        {
+            std::uint64_t data[3] = {}; // value, time enabled, time running
+            if (fds[k] < 0 || ::read(fds[k], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+            {
+                continue;
+            }
+            counts.values[k] = static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+            counts.valid[k] = true;
+        }
+#endif
+        return counts;
+    }
+};
@@ -0,0 +1,355 @@
+#pragma once
+
+#include "aligned_array.hpp"
+#include "benchmark.hpp"
+#include "consumer.hpp"
+#include "paced_benchmark.hpp"
+#include "sweep.hpp"
+#include "wait_benchmark.hpp"
+#include "wait_strategy.hpp"
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <latch>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// Processing graphs of SeqLock rings, such as capture -> filter -> features -> sink. The first
+/// stage is the source and writes into its own ring. Every other stage is a thread that reads the
+/// next block from the ring of each of its inputs, combines them and publishes the result into its
+/// own ring, which any number of downstream stages can read (fan-out). A stage with several inputs
+/// (fan-in) waits until it has the same block from all of them. Element 0 of every block carries
+/// the number of the source block it was made from, so sinks can measure the end-to-end latency.
+/// Only 64-bit integral elements hold every block number exactly, so these are the only types
+
+/// @brief One stage of a pipeline and the stages it reads from, as indices of earlier stages
+struct pipeline_stage
+{
+    std::string name;
+    std::vector<std::size_t> inputs;
+};
+
+/// @brief Graph of stages in topological order, the source first
+struct pipeline_config
+{
+    std::string spec;
+    std::vector<pipeline_stage> stages;
+
+    /// @brief Parse `source;stage<-input;...`: stages separated by ';', each named with the
+    /// stages it reads after `<-`, several inputs joined with '+'. Inputs must be defined earlier,
+    /// so the graph has no cycles. For example `capture;left<-capture;right<-capture;sink<-left+right`
+    [[nodiscard]] static auto parse(const std::string &spec) -> pipeline_config
+    {
+        pipeline_config config{spec, {}};
+        for (const std::string &item : sweep::split(spec, ';'))
+        {
+            const std::size_t arrow = item.find("<-");
+            const std::vector<std::string> name = sweep::split(item.substr(0, arrow), '+');
+            if (name.size() != 1 || config.find(name.front()) < config.stages.size())
+            {
+                throw std::runtime_error("missing or duplicate stage name in pipeline: " + spec);
+            }
+            pipeline_stage stage{name.front(), {}};
+            if (arrow != std::string::npos)
+            {
+                for (const std::string &input : sweep::split(item.substr(arrow + 2), '+'))
+                {
+                    const std::size_t index = config.find(input);
+                    if (index == config.stages.size())
+                    {
+                        throw std::runtime_error("stage " + stage.name + " reads unknown stage " + input);
+                    }
+                    stage.inputs.push_back(index);
+                }
+            }
+            if (config.stages.empty() != stage.inputs.empty())
+            {
+                throw std::runtime_error("a pipeline has a single source, the first stage: " + spec);
+            }
+            config.stages.push_back(stage);
+        }
+        if (config.stages.size() < 2)
+        {
+            throw std::runtime_error("a pipeline needs a source and at least one more stage: " + spec);
+        }
+        return config;
+    }
+
+    /// @brief Index of the stage called `name`, or the number of stages if there is none
+    [[nodiscard]] auto find(const std::string &name) const -> std::size_t
+    {
+        const auto found = std::find_if(stages.begin(), stages.end(), [&name](const pipeline_stage &s)
+                                        { return s.name == name; });
+        return static_cast<std::size_t>(found - stages.begin());
+    }
+
+    /// @brief True if some stage reads the output of stage `index`
+    [[nodiscard]] auto has_consumers(std::size_t index) const -> bool
+    {
+        return std::any_of(stages.begin(), stages.end(), [index](const pipeline_stage &s)
+                           { return std::find(s.inputs.begin(), s.inputs.end(), index) != s.inputs.end(); });
+    }
+};
+
+/// @brief Pacing of the source, one block every `period_ns` or as fast as it can write with 0
+struct pipeline_options
+{
+    std::uint64_t period_ns{0};
+    std::uint64_t spin_ns{50000};
+};
+
+/// @brief What a stage reports besides its processing times
+struct stage_report
+{
+    std::size_t processed{0};
+    std::size_t lost{0};           // blocks of any input overwritten before the stage read them
+    double blocks_per_s{0.0};      // from the first block processed to the last
+    double mean_backlog{0.0};      // published blocks of the input still waiting after each read
+    std::size_t max_backlog{0};
+};
+
+/// @brief Source writing `cycles` blocks, block k filled with k. Its publication time is the
+/// start of block k's end-to-end latency
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void pipeline_source(solution &ring,
+                     std::size_t block_size,
+                     std::size_t cycles,
+                     const pipeline_options &options,
+                     std::vector<std::uint64_t> &origin_ns,
+                     std::latch &thread_latch,
+                     double &write_time_ns,
+                     latency_histogram &histogram)
+{
+    spdlog::info("Pipeline source starts");
+
+    aligned_array<data_type, alignment_bytes> src(block_size);
+    benchmark_timer timer;
+    thread_latch.arrive_and_wait();
+
+    const std::uint64_t start = steady_now_ns() + options.period_ns;
+    write_time_ns = 0;
+    for (std::size_t k = 0; k < cycles; ++k)
+    {
+        fill_array(src, static_cast<data_type>(k));
+        if (options.period_ns > 0)
+        {
+            sleep_until_ns(start + k * options.period_ns, options.spin_ns);
+        }
+        // published by the ring's release store, the readers of block k see it
+        origin_ns[k] = steady_now_ns();
+        const std::uint64_t t0 = timer.start();
+        ring.write(src.data(), block_size);
+        const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+        write_time_ns += static_cast<double>(ns);
+        histogram.record(ns);
+    }
+
+    write_time_ns = cycles > 0 ? write_time_ns / cycles : 0.0;
+    spdlog::info("Pipeline source terminates. Write time, ns: {:.1f}", write_time_ns);
+}
+
+/// @brief Stage reading the next block of every input and publishing their element-wise sum,
+/// with element 0 left at the source block number. Stops after the source's last block, which
+/// is never overwritten and so reaches every stage. Sinks record the end-to-end latency
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void pipeline_worker(const pipeline_config &config,
+                     std::size_t index,
+                     std::deque<solution> &rings,
+                     std::size_t block_size,
+                     std::size_t cycles,
+                     const std::vector<std::uint64_t> &origin_ns,
+                     std::latch &thread_latch,
+                     double &process_time_ns,
+                     latency_histogram &histogram,
+                     latency_histogram &end_to_end,
+                     stage_report &report)
+{
+    const pipeline_stage &stage = config.stages[index];
+    const bool sink = !config.has_consumers(index);
+    spdlog::info("Pipeline stage {} starts with {} inputs", stage.name, stage.inputs.size());
+
+    std::vector<aligned_array<data_type, alignment_bytes>> inputs;
+    for (std::size_t k = 0; k < stage.inputs.size(); ++k)
+    {
+        inputs.emplace_back(block_size);
+    }
+    aligned_array<data_type, alignment_bytes> dst(block_size);
+    std::vector<consumer_cursor> cursors(stage.inputs.size());
+    std::vector<std::size_t> seqs(stage.inputs.size());
+    benchmark_timer timer;
+    std::size_t backlog_sum{0};
+    thread_latch.arrive_and_wait();
+
+    // wait for the next block of input k and return the number of its source block
+    const auto next_from = [&](std::size_t k) -> std::size_t
+    {
+        solution &ring = rings[stage.inputs[k]];
+        while (true)
+        {
+            const read_result result = ring.read_next(inputs[k].data(), block_size, cursors[k]);
+            if (result.status == read_status::ok)
+            {
+                const std::size_t head = ring.head();
+                const std::size_t backlog = head - std::min(head, cursors[k].next);
+                backlog_sum += backlog;
+                report.max_backlog = std::max(report.max_backlog, backlog);
+                return static_cast<std::size_t>(inputs[k].data()[0]);
+            }
+            spin_until([&ring, &cursor = cursors[k]]
+                       { return ring.head() > cursor.next; });
+        }
+    };
+
+    process_time_ns = 0;
+    report = {};
+    std::uint64_t first_ns{0};
+    std::uint64_t last_ns{0};
+    std::size_t seq{0};
+    do
+    {
+        for (std::size_t k = 0; k < seqs.size(); ++k)
+        {
+            seqs[k] = next_from(k);
+        }
+        // inputs that lost blocks are ahead, the others catch up with them
+        for (seq = *std::max_element(seqs.begin(), seqs.end());
+             std::any_of(seqs.begin(), seqs.end(), [seq](std::size_t s)
+                         { return s != seq; });
+             seq = *std::max_element(seqs.begin(), seqs.end()))
+        {
+            for (std::size_t k = 0; k < seqs.size(); ++k)
+            {
+                while (seqs[k] < seq)
+                {
+                    seqs[k] = next_from(k);
+                }
+            }
+        }
+
+        const std::uint64_t t0 = timer.start();
+        std::copy_n(inputs[0].data(), block_size, dst.data());
+        for (std::size_t k = 1; k < inputs.size(); ++k)
+        {
+            std::transform(dst.data() + 1, dst.data() + block_size, inputs[k].data() + 1, dst.data() + 1,
+                           [](data_type a, data_type b)
+                           { return static_cast<data_type>(a + b); });
+        }
+        if (!sink)
+        {
+            rings[index].write(dst.data(), block_size);
+        }
+        const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+
+        last_ns = steady_now_ns();
+        first_ns = report.processed == 0 ? last_ns : first_ns;
+        process_time_ns += static_cast<double>(ns);
+        histogram.record(ns);
+        if (sink)
+        {
+            end_to_end.record(last_ns - std::min(last_ns, origin_ns[seq]));
+        }
+        ++report.processed;
+    } while (seq + 1 < cycles);
+
+    for (const auto &cursor : cursors)
+    {
+        report.lost += cursor.lost;
+    }
+    process_time_ns = report.processed > 0 ? process_time_ns / static_cast<double>(report.processed) : 0.0;
+    report.mean_backlog = report.processed > 0 ? static_cast<double>(backlog_sum) / static_cast<double>(report.processed * cursors.size()) : 0.0;
+    report.blocks_per_s = last_ns > first_ns ? static_cast<double>(report.processed - 1) * 1e9 / static_cast<double>(last_ns - first_ns) : 0.0;
+    spdlog::info("Pipeline stage {} terminates. Processing time, ns: {:.1f}, processed: {}, lost: {}",
+                 stage.name, process_time_ns, report.processed, report.lost);
+}
+
+/// @brief Run the pipeline once. The writer time is the source's write time, reader times and
+/// lost blocks are those of the other stages in the order of the config. The read histogram
+/// merges the stages' processing times, the end-to-end latency of the sinks and the throughput
+/// and backlog of each stage are added as metrics
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+    requires(std::is_integral_v<data_type> && sizeof(data_type) >= sizeof(std::uint64_t))
+benchmark_results run_pipeline_benchmark(const pipeline_config &config,
+                                         std::size_t num_blocks,
+                                         std::size_t block_size,
+                                         std::size_t cycles,
+                                         const pipeline_options &options = {})
+{
+    if (block_size == 0 || cycles == 0)
+    {
+        throw std::runtime_error("a pipeline needs a block size and cycles");
+    }
+    const std::size_t num_stages = config.stages.size() - 1;
+    std::deque<solution> rings;
+    for (std::size_t k = 0; k < config.stages.size(); ++k)
+    {
+        // sinks keep an empty ring so that rings are indexed like the stages
+        rings.emplace_back(config.has_consumers(k) ? num_blocks : 1, config.has_consumers(k) ? block_size : 1);
+        rings.back().fill(data_type{0});
+    }
+
+    std::latch thread_latch(num_stages + 1);
+    benchmark_results results{std::vector<double>(num_stages + 1), std::vector<std::size_t>(num_stages)};
+    results.labels.emplace_back("clock_source", to_string(clock_ticks::calibration().source));
+    results.labels.emplace_back("pipeline", config.spec);
+    std::vector<double> &times = results.times;
+    std::vector<std::uint64_t> origin_ns(cycles);
+
+    std::thread source_thread(pipeline_source<solution, data_type, alignment_bytes>,
+                              std::ref(rings[0]),
+                              block_size,
+                              cycles,
+                              std::cref(options),
+                              std::ref(origin_ns),
+                              std::ref(thread_latch),
+                              std::ref(times[0]),
+                              std::ref(results.write_latency));
+
+    std::vector<latency_histogram> histograms(num_stages);
+    std::vector<latency_histogram> end_to_end(num_stages);
+    std::vector<stage_report> reports(num_stages);
+    std::vector<std::thread> stages;
+    for (std::size_t k = 0; k < num_stages; ++k)
+    {
+        stages.emplace_back(pipeline_worker<solution, data_type, alignment_bytes>,
+                            std::cref(config),
+                            k + 1,
+                            std::ref(rings),
+                            block_size,
+                            cycles,
+                            std::cref(origin_ns),
+                            std::ref(thread_latch),
+                            std::ref(times[k + 1]),
+                            std::ref(histograms[k]),
+                            std::ref(end_to_end[k]),
+                            std::ref(reports[k]));
+    }
+
+    source_thread.join();
+    for (auto &s : stages)
+    {
+        s.join();
+    }
+
+    latency_histogram latency;
+    for (std::size_t k = 0; k < num_stages; ++k)
+    {
+        results.read_latency.merge(histograms[k]);
+        latency.merge(end_to_end[k]);
+        results.lost[k] = reports[k].lost;
+        const std::string &name = config.stages[k + 1].name;
+        results.metrics.emplace_back(fmt::format("stage_{}_blocks_per_s", name), reports[k].blocks_per_s);
+        results.metrics.emplace_back(fmt::format("stage_{}_mean_backlog", name), reports[k].mean_backlog);
+        results.metrics.emplace_back(fmt::format("stage_{}_max_backlog", name), static_cast<double>(reports[k].max_backlog));
+    }
+    results.metrics.emplace_back("end_to_end_mean_ns", latency.mean());
+    results.metrics.emplace_back("end_to_end_p50_ns", static_cast<double>(latency.value_at_percentile(50.0)));
+    results.metrics.emplace_back("end_to_end_p99_ns", static_cast<double>(latency.value_at_percentile(99.0)));
+    results.metrics.emplace_back("end_to_end_max_ns", static_cast<double>(latency.max()));
+    return results;
+}
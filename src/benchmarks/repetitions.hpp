@@ -0,0 +1,137 @@
+#pragma once
+
+#include "benchmark.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+/// @brief Mean, sample standard deviation and half-width of the 95% confidence interval of the mean
+struct sample_statistics
+{
+    double mean{0.0};
+    double stddev{0.0};
+    double ci95{0.0};
+};
+
+/// @brief Two-sided 95% quantile of Student's t distribution with `dof` degrees of freedom
+[[nodiscard]] inline auto student_t95(std::size_t dof) noexcept -> double
+{
+    constexpr double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (dof == 0)
+    {
+        return 0.0;
+    }
+    return dof <= std::size(table) ? table[dof - 1] : 1.960;
+}
+
+[[nodiscard]] inline auto summarise(const std::vector<double> &samples) noexcept -> sample_statistics
+{
+    sample_statistics s;
+    if (samples.empty())
+    {
+        return s;
+    }
+    const double n = static_cast<double>(samples.size());
+    for (const double x : samples)
+    {
+        s.mean += x;
+    }
+    s.mean /= n;
+    if (samples.size() > 1)
+    {
+        double squares{0.0};
+        for (const double x : samples)
+        {
+            squares += (x - s.mean) * (x - s.mean);
+        }
+        s.stddev = std::sqrt(squares / (n - 1.0));
+        s.ci95 = student_t95(samples.size() - 1) * s.stddev / std::sqrt(n);
+    }
+    return s;
+}
+
+/// @brief Statistics of repeated runs of the same benchmark, see combine_repetitions
+struct repeated_results
+{
+    benchmark_results combined;
+    std::size_t repetitions{0};
+    sample_statistics writer;
+    sample_statistics readers; // of the mean reader time of each run
+};
+
+/// @brief Fold repeated runs into one result: times, lags and metrics are averaged, losses are
+/// summed, histograms merged and labels taken from the first run
+[[nodiscard]] inline auto combine_repetitions(const std::vector<benchmark_results> &runs) -> repeated_results
+{
+    if (runs.empty())
+    {
+        throw std::runtime_error("no runs to combine");
+    }
+    repeated_results r;
+    r.repetitions = runs.size();
+    r.combined = runs.front();
+    benchmark_results &c = r.combined;
+    const double n = static_cast<double>(runs.size());
+
+    std::vector<double> writer_times;
+    std::vector<double> reader_times;
+    for (std::size_t k = 0; k < runs.size(); ++k)
+    {
+        const benchmark_results &run = runs[k];
+        if (run.times.size() != c.times.size() || run.lost.size() != c.lost.size() ||
+            run.lag.size() != c.lag.size() || run.metrics.size() != c.metrics.size())
+        {
+            throw std::runtime_error("repeated runs have different shapes");
+        }
+        writer_times.push_back(run.times.front());
+        double readers{0.0};
+        for (std::size_t j = 1; j < run.times.size(); ++j)
+        {
+            readers += run.times[j];
+        }
+        reader_times.push_back(run.times.size() > 1 ? readers / static_cast<double>(run.times.size() - 1) : 0.0);
+
+        if (k == 0)
+        {
+            continue;
+        }
+        for (std::size_t j = 0; j < c.times.size(); ++j)
+        {
+            c.times[j] += run.times[j];
+        }
+        for (std::size_t j = 0; j < c.lost.size(); ++j)
+        {
+            c.lost[j] += run.lost[j];
+        }
+        for (std::size_t j = 0; j < c.lag.size(); ++j)
+        {
+            c.lag[j] += run.lag[j];
+        }
+        for (std::size_t j = 0; j < c.metrics.size(); ++j)
+        {
+            c.metrics[j].second += run.metrics[j].second;
+        }
+        c.write_latency.merge(run.write_latency);
+        c.read_latency.merge(run.read_latency);
+    }
+
+    for (auto &t : c.times)
+    {
+        t /= n;
+    }
+    for (auto &l : c.lag)
+    {
+        l /= n;
+    }
+    for (auto &m : c.metrics)
+    {
+        m.second /= n;
+    }
+    r.writer = summarise(writer_times);
+    r.readers = summarise(reader_times);
+    return r;
+}
@@ -1,43 +1,158 @@
 #pragma once
 
 #include "aligned_array.hpp"
+#include "atomic_copy.hpp"
+#include "consumer.hpp"
+#include "wait_strategy.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <new>
 #include <shared_mutex>
+#include <span>
 #include <vector>
 
+/// @brief Atomic counter alone on its cache lines: the alignment rounds the size up to `false_sharing_range`
 template <std::size_t false_sharing_range = 128>
-    requires(false_sharing_range > sizeof(std::atomic<std::size_t>))
+    requires(false_sharing_range >= sizeof(std::atomic<std::size_t>) &&
+             (false_sharing_range & (false_sharing_range - 1)) == 0)
 struct cursor
 {
     alignas(false_sharing_range) std::atomic<std::size_t> seq;
-    char padding_[(false_sharing_range - sizeof(seq)) % false_sharing_range];
 };
 
-template <typename data_type, std::size_t alignment_bytes>
+static_assert(sizeof(cursor<>) == 128 && alignof(cursor<>) == 128);
+
+/// @brief Where the SeqLock keeps the sequence numbers of its blocks
+enum class sequence_layout
+{
+    separate, // one padded cursor per block in an array of their own, readers touch a cursor line besides the payload
+    inline_header, // the sequence heads the block's cache line aligned slot and shares its first line with the payload
+    global         // a single sequence for the whole ring, any write makes every concurrent read retry
+};
+
+template <typename data_type, std::size_t alignment_bytes, typename copy_policy = memcpy_copy, typename wait_policy = busy_spin,
+          sequence_layout layout = sequence_layout::separate>
+    requires(layout != sequence_layout::inline_header || 64 % sizeof(data_type) == 0)
 class seqlock_solution
 {
+    static constexpr std::size_t cache_line = 64;
+    static constexpr std::size_t storage_alignment = layout == sequence_layout::inline_header ? std::max(alignment_bytes, cache_line) : alignment_bytes;
+    // the header keeps the payload aligned to alignment_bytes
+    static constexpr std::size_t header_elements = layout == sequence_layout::inline_header
+                                                       ? (std::max(sizeof(std::atomic<std::size_t>), alignment_bytes) + sizeof(data_type) - 1) / sizeof(data_type)
+                                                       : 0;
+
     std::size_t n_blocks;
     std::size_t b_size;
+    std::size_t slot_elements; // distance between consecutive blocks in the array
     std::vector<cursor<>> cursors;
+    cursor<> published;
+    cursor<> parked; // consumers blocked in wait_policy::wait
     std::size_t offset_write;
-    aligned_array<data_type, alignment_bytes> a;
+    aligned_array<data_type, storage_alignment> a;
+
+    [[nodiscard]] static auto slot_size(std::size_t block_size) noexcept -> std::size_t
+    {
+        if constexpr (layout == sequence_layout::inline_header)
+        {
+            const std::size_t bytes = (header_elements + block_size) * sizeof(data_type);
+            return (bytes + cache_line - 1) / cache_line * cache_line / sizeof(data_type);
+        }
+        return block_size;
+    }
+
+    [[nodiscard]] auto sequence(std::size_t index) -> std::atomic<std::size_t> &
+    {
+        if constexpr (layout == sequence_layout::inline_header)
+        {
+            return *std::launder(reinterpret_cast<std::atomic<std::size_t> *>(a.offset(index * slot_elements)));
+        }
+        else if constexpr (layout == sequence_layout::global)
+        {
+            return cursors[0].seq;
+        }
+        else
+        {
+            return cursors[index].seq;
+        }
+    }
+
+    [[nodiscard]] auto block(std::size_t index) const -> data_type *
+    {
+        return a.offset(index * slot_elements + header_elements);
+    }
+
+    /// @brief Copy block `index` out, telling policies that prefetch which block comes next
+    void load_block(data_type *dst, std::size_t index, std::size_t size) const
+    {
+        if constexpr (requires { copy_policy::load(dst, block(index), size, block(index)); })
+        {
+            copy_policy::load(dst, block(index), size, block((index + 1) % n_blocks));
+        }
+        else
+        {
+            copy_policy::load(dst, block(index), size);
+        }
+    }
+
+    /// @brief True if block k of the global sequence is still intact when its sequence reads `seq`.
+    /// The k-th write into a block leaves its own sequence at 2k, while the global sequence
+    /// stays valid for block k until the writer starts on block k + n_blocks
+    [[nodiscard]] auto intact(std::size_t k, std::size_t seq) const noexcept -> bool
+    {
+        if constexpr (layout == sequence_layout::global)
+        {
+            return seq <= 2 * (k + n_blocks);
+        }
+        return seq == 2 * (k / n_blocks + 1);
+    }
 
 public:
-    seqlock_solution(std::size_t num_blocks, std::size_t block_size)
+    using wait_policy_type = wait_policy;
+
+    seqlock_solution(std::size_t num_blocks, std::size_t block_size, const page_options &pages = {})
         : n_blocks(num_blocks),
           b_size(block_size),
-          cursors(num_blocks),
+          slot_elements(slot_size(block_size)),
+          cursors(layout == sequence_layout::separate ? num_blocks : layout == sequence_layout::global ? 1 : 0),
+          published{0},
+          parked{0},
           offset_write(0),
-          a(num_blocks * block_size)
+          a(num_blocks * slot_size(block_size), pages)
     {
+        if constexpr (layout == sequence_layout::inline_header)
+        {
+            for (std::size_t k = 0; k < n_blocks; ++k)
+            {
+                new (a.offset(k * slot_elements)) std::atomic<std::size_t>{0};
+            }
+        }
     }
     ~seqlock_solution() = default;
 
     [[nodiscard]] auto size() noexcept -> std::size_t { return n_blocks * b_size; }
+    [[nodiscard]] auto backend() const noexcept -> page_backend { return a.backend(); }
 
+    /// @brief Number of blocks written so far. Block k of the global sequence is stored at index k % n_blocks
+    [[nodiscard]] auto head() const noexcept -> std::size_t { return published.seq.load(std::memory_order_acquire); }
+
+    /// @brief Block the calling consumer with wait_policy until the writer has published block `next`
+    void wait(std::size_t next) noexcept
+    {
+        for (std::size_t head_seq = head(); head_seq <= next; head_seq = head())
+        {
+            wait_policy::wait(published.seq, head_seq, parked.seq);
+        }
+    }
+
+    /// @brief Fill the payload of every block, inline sequence headers are left alone
     void fill(data_type value)
     {
-        fill_array(a, value);
+        for (std::size_t k = 0; k < n_blocks; ++k)
+        {
+            std::fill_n(block(k), b_size, value);
+        }
     }
 
     void write(const data_type *src, std::size_t size)
@@ -45,14 +160,17 @@ public:
         if (src != nullptr && size == b_size)
         {
             const size_t index = offset_write / size;
-            std::size_t seq0 = cursors[index].seq.load(std::memory_order_relaxed);
-            cursors[index].seq.store(seq0 + 1, std::memory_order_release);
-            std::atomic_signal_fence(std::memory_order_acq_rel);
-            std::memcpy(a.offset(offset_write), src, size * sizeof(data_type));
+            auto &seq = sequence(index);
+            std::size_t seq0 = seq.load(std::memory_order_relaxed);
+            seq.store(seq0 + 1, std::memory_order_release);
+            copy_policy::write_fence();
+            copy_policy::store(block(index), src, size);
             std::atomic_signal_fence(std::memory_order_acq_rel);
-            cursors[index].seq.store(seq0 + 2, std::memory_order_release);
+            seq.store(seq0 + 2, std::memory_order_release);
+            published.seq.store(published.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            wait_policy::notify(published.seq, parked.seq);
             offset_write += size;
-            offset_write = offset_write % a.size();
+            offset_write = offset_write % (n_blocks * b_size);
             return;
         }
         throw std::runtime_error("invalid pointer or block size");
@@ -63,19 +181,190 @@ public:
         if (dst != nullptr && size == b_size)
         {
             const size_t index = offset / size;
+            auto &seq = sequence(index);
             std::size_t seq0;
             std::size_t seq1;
             do
             {
-                seq0 = cursors[index].seq.load(std::memory_order_acquire);
+                seq0 = seq.load(std::memory_order_acquire);
                 std::atomic_signal_fence(std::memory_order_acq_rel);
-                std::memcpy(dst, a.offset(offset), size * sizeof(data_type));
-                std::atomic_signal_fence(std::memory_order_acq_rel);
-                seq1 = cursors[index].seq.load(std::memory_order_acquire);
+                load_block(dst, index, size);
+                copy_policy::read_fence();
+                seq1 = seq.load(std::memory_order_acquire);
             } while (seq0 != seq1 || seq0 & 1);
 
             return;
         }
         throw std::runtime_error("invalid pointer or block size");
     }
-};
\ No newline at end of file
+
+    /// @brief Write `size / b_size` consecutive blocks, wrapping around the end of the ring.
+    /// All blocks of the batch are marked busy, copied and then published together.
+    /// Batches need the blocks next to each other and a sequence per block.
+    /// This is not a single sequence transition per batch: readers of one block only check that
+    /// block's sequence, so each block still gets its two stores. The batch shares the fence,
+    /// the copy and the head update, and a batch sequence would cost every single block read a second check
+    void write_batch(const data_type *src, std::size_t size)
+        requires(layout == sequence_layout::separate)
+    {
+        if (src != nullptr && size > 0 && size % b_size == 0 && size <= a.size())
+        {
+            const std::size_t first = offset_write / b_size;
+            const std::size_t count = size / b_size;
+            for (std::size_t k = 0; k < count; ++k)
+            {
+                auto &seq = cursors[(first + k) % n_blocks].seq;
+                seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+            copy_policy::write_fence();
+            const std::size_t head_part = std::min(size, a.size() - offset_write);
+            copy_policy::store(a.offset(offset_write), src, head_part);
+            if (head_part < size)
+            {
+                copy_policy::store(a.offset(0), src + head_part, size - head_part);
+            }
+            std::atomic_signal_fence(std::memory_order_acq_rel);
+            for (std::size_t k = 0; k < count; ++k)
+            {
+                auto &seq = cursors[(first + k) % n_blocks].seq;
+                seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+            published.seq.store(published.seq.load(std::memory_order_relaxed) + count, std::memory_order_release);
+            wait_policy::notify(published.seq, parked.seq);
+            offset_write += size;
+            offset_write = offset_write % a.size();
+            return;
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+
+    /// @brief Read `size / b_size` consecutive blocks starting at `offset`, wrapping around the end of the ring.
+    /// Sequences only grow, so equal sums of even sequences before and after the copy mean no block changed
+    void read_batch(data_type *dst, std::size_t size, std::size_t offset)
+        requires(layout == sequence_layout::separate)
+    {
+        if (dst != nullptr && size > 0 && size % b_size == 0 && size <= a.size() &&
+            offset < a.size() && offset % b_size == 0)
+        {
+            const std::size_t first = offset / b_size;
+            const std::size_t count = size / b_size;
+            const std::size_t head_part = std::min(size, a.size() - offset);
+            std::size_t sum0;
+            std::size_t sum1;
+            bool busy;
+            do
+            {
+                sum0 = 0;
+                busy = false;
+                for (std::size_t k = 0; k < count; ++k)
+                {
+                    const std::size_t seq = cursors[(first + k) % n_blocks].seq.load(std::memory_order_acquire);
+                    busy = busy || (seq & 1);
+                    sum0 += seq;
+                }
+                std::atomic_signal_fence(std::memory_order_acq_rel);
+                copy_policy::load(dst, a.offset(offset), head_part);
+                if (head_part < size)
+                {
+                    copy_policy::load(dst + head_part, a.offset(0), size - head_part);
+                }
+                copy_policy::read_fence();
+                sum1 = 0;
+                for (std::size_t k = 0; k < count; ++k)
+                {
+                    sum1 += cursors[(first + k) % n_blocks].seq.load(std::memory_order_acquire);
+                }
+            } while (busy || sum0 != sum1);
+
+            return;
+        }
+        throw std::runtime_error("invalid pointer, offset or batch size");
+    }
+
+    /// @brief Pass a read-only view of the block at `offset` to `visitor` instead of copying it out.
+    /// Returns false if the writer touched the block while it was visited, in which case whatever
+    /// the visitor computed must be discarded and the read retried
+    template <typename visitor>
+    [[nodiscard]] bool read_view(std::size_t offset, visitor &&visit)
+    {
+        if (offset < size() && offset % b_size == 0)
+        {
+            const size_t index = offset / b_size;
+            auto &seq = sequence(index);
+            const std::size_t seq0 = seq.load(std::memory_order_acquire);
+            if (seq0 & 1)
+            {
+                return false;
+            }
+            std::atomic_signal_fence(std::memory_order_acq_rel);
+            visit(std::span<const data_type>(block(index), b_size));
+            std::atomic_signal_fence(std::memory_order_acq_rel);
+            return seq.load(std::memory_order_acquire) == seq0;
+        }
+        throw std::runtime_error("invalid block offset");
+    }
+
+    /// @brief Read the oldest block the consumer has not seen yet. Blocks overwritten before
+    /// the consumer got to them are skipped and reported in read_result::lost
+    auto read_next(data_type *dst, std::size_t size, consumer_cursor &consumer) -> read_result
+    {
+        if (dst != nullptr && size == b_size)
+        {
+            std::size_t lost{0};
+            while (true)
+            {
+                const std::size_t head_seq = published.seq.load(std::memory_order_acquire);
+                if (consumer.next >= head_seq)
+                {
+                    return {read_status::not_ready, lost};
+                }
+                if (head_seq - consumer.next > n_blocks)
+                {
+                    lost += head_seq - n_blocks - consumer.next;
+                    consumer.next = head_seq - n_blocks;
+                }
+
+                const std::size_t index = consumer.next % n_blocks;
+                auto &seq = sequence(index);
+                if (intact(consumer.next, seq.load(std::memory_order_acquire)))
+                {
+                    std::atomic_signal_fence(std::memory_order_acq_rel);
+                    load_block(dst, index, size);
+                    copy_policy::read_fence();
+                    if (intact(consumer.next, seq.load(std::memory_order_acquire)))
+                    {
+                        ++consumer.next;
+                        consumer.lost += lost;
+                        return {read_status::ok, lost};
+                    }
+                }
+                // the writer has lapped the consumer and is overwriting this block, catch up
+            }
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+};
+
+/// @brief SeqLock without data races: the payload is copied with relaxed atomic loads and stores
+template <typename data_type, std::size_t alignment_bytes>
+using atomic_seqlock_solution = seqlock_solution<data_type, alignment_bytes, atomic_copy>;
+
+/// @brief Race-free SeqLock that switches to vector copies for large blocks
+template <typename data_type, std::size_t alignment_bytes>
+using simd_seqlock_solution = seqlock_solution<data_type, alignment_bytes, simd_atomic_copy<>>;
+
+/// @brief SeqLock whose sequence numbers head their blocks instead of living in a cursor array
+template <typename data_type, std::size_t alignment_bytes>
+using inline_seqlock_solution = seqlock_solution<data_type, alignment_bytes, memcpy_copy, busy_spin, sequence_layout::inline_header>;
+
+/// @brief SeqLock with one sequence number for the whole ring
+template <typename data_type, std::size_t alignment_bytes>
+using global_seqlock_solution = seqlock_solution<data_type, alignment_bytes, memcpy_copy, busy_spin, sequence_layout::global>;
+
+/// @brief SeqLock that writes large blocks with non-temporal stores
+template <typename data_type, std::size_t alignment_bytes>
+using streaming_seqlock_solution = seqlock_solution<data_type, alignment_bytes, streaming_copy<>>;
+
+/// @brief streaming_seqlock_solution whose readers prefetch the block after the one they read
+template <typename data_type, std::size_t alignment_bytes>
+using prefetch_seqlock_solution = seqlock_solution<data_type, alignment_bytes, streaming_copy<32768, true>>;
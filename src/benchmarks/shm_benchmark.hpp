@@ -0,0 +1,249 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include "aligned_array.hpp"
+#include "benchmark.hpp"
+#include "latency_histogram.hpp"
+#include "shm_solution.hpp"
+#include "timer.hpp"
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// @brief Start line and per-reader results shared between the benchmark and its forked readers
+struct shm_benchmark_control
+{
+    struct reader_result
+    {
+        double read_time_ns;
+        std::uint64_t lost;
+        std::uint32_t attached; // the reader counted itself in `ready`
+        std::uint32_t failed;
+        latency_histogram histogram;
+    };
+
+    alignas(128) std::atomic<std::uint32_t> ready;
+    alignas(128) std::atomic<std::uint32_t> go;
+
+    [[nodiscard]] static auto bytes(std::size_t num_readers) noexcept -> std::size_t
+    {
+        return sizeof(shm_benchmark_control) + num_readers * sizeof(reader_result);
+    }
+
+    /// @brief Results of reader `index`, stored right after the control block in the same mapping
+    [[nodiscard]] auto reader(std::size_t index) noexcept -> reader_result &
+    {
+        return reinterpret_cast<reader_result *>(this + 1)[index];
+    }
+};
+
+/// @brief Body of a forked reader process: attach to the ring by name and follow the writer's sequence
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void shm_reader_process(const std::string &name,
+                        std::size_t cycles,
+                        std::size_t sample_every,
+                        shm_benchmark_control &control,
+                        shm_benchmark_control::reader_result &result)
+{
+    solution store(name);
+    aligned_array<data_type, alignment_bytes> dst(store.block_size());
+    consumer_cursor consumer;
+    benchmark_timer timer(sample_every);
+    latency_histogram histogram;
+
+    result.attached = 1;
+    control.ready.fetch_add(1, std::memory_order_acq_rel);
+    while (control.go.load(std::memory_order_acquire) == 0)
+    {
+        std::this_thread::yield();
+    }
+
+    double read_time_ns{0};
+    std::size_t timed{0};
+    while (consumer.next < cycles)
+    {
+        read_result r{read_status::not_ready, 0};
+        if (timer.sample())
+        {
+            const std::uint64_t t0 = timer.start();
+            r = store.read_next(dst.data(), store.block_size(), consumer);
+            const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+            if (r.status == read_status::ok)
+            {
+                read_time_ns += static_cast<double>(ns);
+                histogram.record(ns);
+                ++timed;
+            }
+        }
+        else
+        {
+            r = store.read_next(dst.data(), store.block_size(), consumer);
+        }
+        if (r.status != read_status::ok && !store.writer_alive(std::chrono::seconds(1)) && consumer.next >= store.head())
+        {
+            break;
+        }
+    }
+
+    result.read_time_ns = timed > 0 ? read_time_ns / timed : 0.0;
+    result.lost = consumer.lost + (cycles - consumer.next);
+    result.histogram = histogram;
+}
+
+/// @brief Writer in this process, every reader in a forked process attached to a named shared memory ring
+template <typename data_type, std::size_t alignment_bytes>
+benchmark_results run_shm_benchmark(std::size_t num_blocks,
+                                    std::size_t block_size,
+                                    std::size_t num_readers,
+                                    std::size_t cycles,
+                                    std::size_t sample_every = 1)
+{
+    using solution = shm_seqlock_solution<data_type, alignment_bytes>;
+    const std::string name = fmt::format("/spmc_benchmark_{}", ::getpid());
+    solution store(name, num_blocks, block_size);
+    store.fill(data_type{12345});
+
+    const std::size_t control_bytes = shm_benchmark_control::bytes(num_readers);
+    void *control_memory = ::mmap(nullptr, control_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (control_memory == MAP_FAILED)
+    {
+        throw std::system_error(errno, std::generic_category(), "mmap");
+    }
+    auto *control = new (control_memory) shm_benchmark_control{};
+    for (std::size_t k = 0; k < num_readers; ++k)
+    {
+        new (&control->reader(k)) shm_benchmark_control::reader_result{};
+    }
+
+    // calibrate the clock once here rather than in every reader process
+    benchmark_results results{std::vector<double>(num_readers + 1), std::vector<std::size_t>(num_readers)};
+    results.labels.emplace_back("clock_source", to_string(clock_ticks::calibration().source));
+
+    struct child
+    {
+        pid_t pid;
+        std::size_t reader;
+        bool reaped;
+    };
+    std::vector<child> children;
+    for (std::size_t k = 0; k < num_readers; ++k)
+    {
+        const pid_t pid = ::fork();
+        if (pid == 0)
+        {
+            int status = 0;
+            try
+            {
+                shm_reader_process<solution, data_type, alignment_bytes>(name, cycles, sample_every, *control, control->reader(k));
+            }
+            catch (...)
+            {
+                control->reader(k).failed = 1;
+                if (control->reader(k).attached == 0)
+                {
+                    control->ready.fetch_add(1, std::memory_order_acq_rel);
+                }
+                status = 1;
+            }
+            ::_exit(status);
+        }
+        if (pid < 0)
+        {
+            spdlog::error("fork failed for reader {}", k);
+            control->reader(k).failed = 1;
+            control->ready.fetch_add(1, std::memory_order_acq_rel);
+            continue;
+        }
+        children.push_back({pid, k, false});
+    }
+
+    // a reader killed before it got ready never counts itself, so reap children while waiting
+    std::uint32_t dead{0};
+    while (control->ready.load(std::memory_order_acquire) + dead < num_readers)
+    {
+        for (auto &c : children)
+        {
+            int status = 0;
+            if (!c.reaped && ::waitpid(c.pid, &status, WNOHANG) == c.pid)
+            {
+                c.reaped = true;
+                auto &result = control->reader(c.reader);
+                if (result.attached == 0 && result.failed == 0)
+                {
+                    ++dead;
+                }
+                if (result.attached == 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                {
+                    result.failed = 1;
+                }
+            }
+        }
+        std::this_thread::yield();
+    }
+    spdlog::info("Shared memory writer starts, {} consumer processes attached", store.consumers());
+
+    data_type value{0};
+    aligned_array<data_type, alignment_bytes> src(block_size);
+    fill_array(src, value++);
+    store.write(src.data(), block_size);
+    control->go.store(1, std::memory_order_release);
+
+    benchmark_timer timer(sample_every);
+    double write_time_ns{0};
+    std::size_t timed{0};
+    for (size_t k = 1; k < cycles; ++k)
+    {
+        fill_array(src, value++);
+        if (timer.sample())
+        {
+            const std::uint64_t t0 = timer.start();
+            store.write(src.data(), block_size);
+            const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+            write_time_ns += static_cast<double>(ns);
+            results.write_latency.record(ns);
+            ++timed;
+        }
+        else
+        {
+            store.write(src.data(), block_size);
+        }
+    }
+    results.times[0] = timed > 0 ? write_time_ns / timed : 0.0;
+    spdlog::info("Shared memory writer terminates. Write time, ns: {:.1f}", results.times[0]);
+
+    for (const auto &c : children)
+    {
+        int status = 0;
+        if (!c.reaped && (::waitpid(c.pid, &status, 0) != c.pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0))
+        {
+            control->reader(c.reader).failed = 1;
+        }
+    }
+
+    for (std::size_t k = 0; k < num_readers; ++k)
+    {
+        if (control->reader(k).failed != 0)
+        {
+            spdlog::error("Shared memory reader {} failed", k);
+        }
+        results.times[k + 1] = control->reader(k).read_time_ns;
+        results.lost[k] = control->reader(k).lost;
+        results.read_latency.merge(control->reader(k).histogram);
+    }
+    ::munmap(control_memory, control_bytes);
+    return results;
+}
+
+#endif
@@ -0,0 +1,369 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include "atomic_copy.hpp"
+#include "consumer.hpp"
+#include "seqlock_solution.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// @brief Layout of the start of a shared memory ring. The geometry is fixed by the writer when
+/// the region is created; consumers check it against their own data type on attach
+struct shm_header
+{
+    static constexpr std::uint64_t expected_magic = 0x53504d4352494e47; // "SPMCRING"
+    static constexpr std::uint32_t current_version = 1;
+
+    std::atomic<std::uint64_t> magic; // stored last, so a consumer that sees it also sees the geometry
+    std::uint32_t version;
+    std::uint32_t element_size;
+    std::uint64_t num_blocks;
+    std::uint64_t block_size;
+    std::uint64_t cursors_offset; // bytes from the start of the region
+    std::uint64_t payload_offset; // bytes from the start of the region
+    alignas(128) std::atomic<std::uint64_t> heartbeat; // steady_clock time of the writer's last sign of life, ns
+    std::atomic<std::uint32_t> writer_closed;
+    alignas(128) std::atomic<std::uint64_t> published;
+    alignas(128) std::atomic<std::uint32_t> consumers;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared memory cursors must be address-free");
+
+/// @brief SeqLock ring whose cursors and payload live in a POSIX shared memory object, so that
+/// the writer and its consumers can run in separate processes. The process that creates the region
+/// is the writer and unlinks it on destruction; consumers attach to it by name
+template <typename data_type, std::size_t alignment_bytes, typename copy_policy = memcpy_copy>
+class shm_seqlock_solution
+{
+    static constexpr std::uint64_t heartbeat_period = 64; // blocks between heartbeats
+
+    std::string region_name;
+    bool owner;
+    std::size_t region_bytes;
+    void *base;
+    shm_header *header;
+    cursor<> *cursors;
+    data_type *payload;
+    std::size_t n_blocks;
+    std::size_t b_size;
+    std::size_t offset_write;
+
+public:
+    /// @brief Create the region `name` (e.g. "/spmc_ring") and become its writer
+    shm_seqlock_solution(const std::string &name, std::size_t num_blocks, std::size_t block_size)
+        : region_name(name),
+          owner(true),
+          region_bytes(0),
+          base(nullptr),
+          header(nullptr),
+          cursors(nullptr),
+          payload(nullptr),
+          n_blocks(num_blocks),
+          b_size(block_size),
+          offset_write(0)
+    {
+        if (num_blocks == 0 || block_size == 0)
+        {
+            throw std::runtime_error("invalid number of blocks or block size");
+        }
+        const std::size_t cursors_offset = round_up(sizeof(shm_header), sizeof(cursor<>));
+        const std::size_t payload_offset = round_up(cursors_offset + num_blocks * sizeof(cursor<>), payload_alignment());
+        region_bytes = payload_offset + num_blocks * block_size * sizeof(data_type);
+
+        const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        }
+        if (::ftruncate(fd, static_cast<off_t>(region_bytes)) != 0)
+        {
+            const int error = errno;
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::system_error(error, std::generic_category(), "ftruncate " + name);
+        }
+        map(fd);
+
+        header = new (base) shm_header{};
+        header->version = shm_header::current_version;
+        header->element_size = sizeof(data_type);
+        header->num_blocks = num_blocks;
+        header->block_size = block_size;
+        header->cursors_offset = cursors_offset;
+        header->payload_offset = payload_offset;
+        locate();
+        for (std::size_t k = 0; k < num_blocks; ++k)
+        {
+            new (cursors + k) cursor<>{};
+        }
+        beat();
+        header->magic.store(shm_header::expected_magic, std::memory_order_release);
+    }
+
+    /// @brief Attach to the region `name` as a consumer
+    explicit shm_seqlock_solution(const std::string &name)
+        : region_name(name),
+          owner(false),
+          region_bytes(0),
+          base(nullptr),
+          header(nullptr),
+          cursors(nullptr),
+          payload(nullptr),
+          n_blocks(0),
+          b_size(0),
+          offset_write(0)
+    {
+        const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(shm_header))
+        {
+            ::close(fd);
+            throw std::runtime_error("shared memory region is too small: " + name);
+        }
+        region_bytes = static_cast<std::size_t>(st.st_size);
+        map(fd);
+
+        if (header->magic.load(std::memory_order_acquire) != shm_header::expected_magic ||
+            header->version != shm_header::current_version ||
+            header->element_size != sizeof(data_type) ||
+            header->num_blocks == 0 || header->block_size == 0 ||
+            header->cursors_offset + header->num_blocks * sizeof(cursor<>) > header->payload_offset ||
+            header->payload_offset % payload_alignment() != 0 ||
+            header->payload_offset + header->num_blocks * header->block_size * sizeof(data_type) > region_bytes)
+        {
+            unmap();
+            throw std::runtime_error("shared memory region has an incompatible layout: " + name);
+        }
+        n_blocks = header->num_blocks;
+        b_size = header->block_size;
+        locate();
+        header->consumers.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    shm_seqlock_solution(const shm_seqlock_solution &) = delete;
+    shm_seqlock_solution &operator=(const shm_seqlock_solution &) = delete;
+
+    shm_seqlock_solution(shm_seqlock_solution &&other) noexcept
+        : region_name(std::move(other.region_name)),
+          owner(std::exchange(other.owner, false)),
+          region_bytes(std::exchange(other.region_bytes, 0)),
+          base(std::exchange(other.base, nullptr)),
+          header(std::exchange(other.header, nullptr)),
+          cursors(std::exchange(other.cursors, nullptr)),
+          payload(std::exchange(other.payload, nullptr)),
+          n_blocks(other.n_blocks),
+          b_size(other.b_size),
+          offset_write(other.offset_write)
+    {
+    }
+
+    ~shm_seqlock_solution()
+    {
+        detach();
+    }
+
+    /// @brief Leave the region. The writer marks it closed and unlinks the name; the memory
+    /// itself stays valid until the last process unmaps it
+    void detach() noexcept
+    {
+        if (header == nullptr)
+        {
+            return;
+        }
+        if (owner)
+        {
+            header->writer_closed.store(1, std::memory_order_release);
+            ::shm_unlink(region_name.c_str());
+        }
+        else
+        {
+            header->consumers.fetch_sub(1, std::memory_order_relaxed);
+        }
+        unmap();
+    }
+
+    [[nodiscard]] auto name() const noexcept -> const std::string & { return region_name; }
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return n_blocks * b_size; }
+    [[nodiscard]] auto block_size() const noexcept -> std::size_t { return b_size; }
+    [[nodiscard]] auto num_blocks() const noexcept -> std::size_t { return n_blocks; }
+    [[nodiscard]] auto consumers() const noexcept -> std::size_t { return header->consumers.load(std::memory_order_relaxed); }
+    [[nodiscard]] auto head() const noexcept -> std::size_t { return header->published.load(std::memory_order_acquire); }
+
+    /// @brief Record that the writer is alive. write() does this every few blocks on its own
+    void beat() noexcept
+    {
+        header->heartbeat.store(now_ns(), std::memory_order_relaxed);
+    }
+
+    /// @brief True while the writer has not closed the region and has shown a sign of life within `timeout`
+    [[nodiscard]] bool writer_alive(std::chrono::nanoseconds timeout) const noexcept
+    {
+        if (header->writer_closed.load(std::memory_order_acquire) != 0)
+        {
+            return false;
+        }
+        const std::uint64_t last = header->heartbeat.load(std::memory_order_relaxed);
+        const std::uint64_t now = now_ns();
+        return last >= now || now - last <= static_cast<std::uint64_t>(timeout.count());
+    }
+
+    void fill(data_type value)
+    {
+        std::fill(payload, payload + size(), value);
+    }
+
+    void write(const data_type *src, std::size_t size)
+    {
+        if (owner && src != nullptr && size == b_size)
+        {
+            const size_t index = offset_write / size;
+            std::atomic<std::size_t> &seq = cursors[index].seq;
+            const std::size_t seq0 = seq.load(std::memory_order_relaxed);
+            seq.store(seq0 + 1, std::memory_order_release);
+            copy_policy::write_fence();
+            copy_policy::store(payload + offset_write, src, size);
+            std::atomic_signal_fence(std::memory_order_acq_rel);
+            seq.store(seq0 + 2, std::memory_order_release);
+            const std::uint64_t published = header->published.load(std::memory_order_relaxed) + 1;
+            header->published.store(published, std::memory_order_release);
+            if (published % heartbeat_period == 0)
+            {
+                beat();
+            }
+            offset_write += size;
+            offset_write = offset_write % this->size();
+            return;
+        }
+        throw std::runtime_error("invalid pointer or block size, or not the writer");
+    }
+
+    void read(data_type *dst, std::size_t size, std::size_t offset)
+    {
+        if (dst != nullptr && size == b_size && offset < this->size())
+        {
+            const size_t index = offset / size;
+            std::size_t seq0;
+            std::size_t seq1;
+            do
+            {
+                seq0 = cursors[index].seq.load(std::memory_order_acquire);
+                std::atomic_signal_fence(std::memory_order_acq_rel);
+                copy_policy::load(dst, payload + offset, size);
+                copy_policy::read_fence();
+                seq1 = cursors[index].seq.load(std::memory_order_acquire);
+            } while (seq0 != seq1 || seq0 & 1);
+
+            return;
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+
+    /// @brief Same contract as seqlock_solution::read_next
+    auto read_next(data_type *dst, std::size_t size, consumer_cursor &consumer) -> read_result
+    {
+        if (dst != nullptr && size == b_size)
+        {
+            std::size_t lost{0};
+            while (true)
+            {
+                const std::size_t head_seq = header->published.load(std::memory_order_acquire);
+                if (consumer.next >= head_seq)
+                {
+                    return {read_status::not_ready, lost};
+                }
+                if (head_seq - consumer.next > n_blocks)
+                {
+                    lost += head_seq - n_blocks - consumer.next;
+                    consumer.next = head_seq - n_blocks;
+                }
+
+                const std::size_t index = consumer.next % n_blocks;
+                const std::size_t expected = 2 * (consumer.next / n_blocks + 1);
+                if (cursors[index].seq.load(std::memory_order_acquire) == expected)
+                {
+                    std::atomic_signal_fence(std::memory_order_acq_rel);
+                    copy_policy::load(dst, payload + index * size, size);
+                    copy_policy::read_fence();
+                    if (cursors[index].seq.load(std::memory_order_acquire) == expected)
+                    {
+                        ++consumer.next;
+                        consumer.lost += lost;
+                        return {read_status::ok, lost};
+                    }
+                }
+            }
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+
+private:
+    [[nodiscard]] static constexpr auto round_up(std::size_t value, std::size_t multiple) noexcept -> std::size_t
+    {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    [[nodiscard]] static constexpr auto payload_alignment() noexcept -> std::size_t
+    {
+        return alignment_bytes > 128 ? alignment_bytes : 128;
+    }
+
+    [[nodiscard]] static auto now_ns() noexcept -> std::uint64_t
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+    }
+
+    /// @brief Map the whole region and close the descriptor, the mapping keeps the object alive
+    void map(int fd)
+    {
+        base = ::mmap(nullptr, region_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);
+        if (base == MAP_FAILED)
+        {
+            base = nullptr;
+            if (owner)
+            {
+                ::shm_unlink(region_name.c_str());
+            }
+            throw std::system_error(error, std::generic_category(), "mmap " + region_name);
+        }
+        header = static_cast<shm_header *>(base);
+    }
+
+    void unmap() noexcept
+    {
+        ::munmap(base, region_bytes);
+        base = nullptr;
+        header = nullptr;
+        cursors = nullptr;
+        payload = nullptr;
+    }
+
+    void locate() noexcept
+    {
+        cursors = reinterpret_cast<cursor<> *>(static_cast<char *>(base) + header->cursors_offset);
+        payload = reinterpret_cast<data_type *>(static_cast<char *>(base) + header->payload_offset);
+    }
+};
+
+#endif
@@ -12,8 +12,8 @@ class ring_buffer
     aligned_array<data_type, alignment_bytes> a;
 
 public:
-    ring_buffer(std::size_t num_elements)
-        : a(num_elements)
+    ring_buffer(std::size_t num_elements, const page_options &pages = {})
+        : a(num_elements, pages)
     {
     }
 
@@ -22,6 +22,8 @@ public:
         fill_array(a, value);
     }
 
+    [[nodiscard]] auto backend() const noexcept -> page_backend { return a.backend(); }
+
     [[nodiscard]] auto write_offset(std::size_t d) const -> data_type *
     {
         return a.offset(d);
@@ -43,9 +45,9 @@ class memcpy_test_buffer
     aligned_array<data_type, alignment_bytes> b;
 
 public:
-    memcpy_test_buffer(std::size_t num_elements)
-        : a(num_elements),
-          b(num_elements)
+    memcpy_test_buffer(std::size_t num_elements, const page_options &pages = {})
+        : a(num_elements, pages),
+          b(num_elements, pages)
     {
         fill_array(b, data_type{});
     }
@@ -55,6 +57,8 @@ public:
         fill_array(a, value);
     }
 
+    [[nodiscard]] auto backend() const noexcept -> page_backend { return a.backend(); }
+
     [[nodiscard]] auto write_offset(std::size_t d) const -> data_type *
     {
         return a.offset(d);
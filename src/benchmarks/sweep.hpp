@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/// Parsing of the sweep axes given on the command line. A list is made of comma separated
+/// items, each item is either a single value or a range `first:last[:step]`. The step is added
+/// (`+4` or `4`) or multiplied (`x2`), the default step is +1. Ranges include `last` when the
+/// step lands on it, e.g. "16:128:x2" is 16, 32, 64, 128 and "1:5" is 1, 2, 3, 4, 5
+
+namespace sweep
+{
+    [[nodiscard]] inline auto split(const std::string &text, char separator = ',') -> std::vector<std::string>
+    {
+        std::vector<std::string> items;
+        std::size_t start = 0;
+        while (start <= text.size())
+        {
+            const std::size_t end = std::min(text.find(separator, start), text.size());
+            std::string item = text.substr(start, end - start);
+            item.erase(0, item.find_first_not_of(" \t"));
+            item.erase(item.find_last_not_of(" \t") + 1);
+            if (!item.empty())
+            {
+                items.push_back(item);
+            }
+            start = end + 1;
+        }
+        return items;
+    }
+
+    [[nodiscard]] inline auto to_size(const std::string &text) -> std::size_t
+    {
+        std::size_t used = 0;
+        unsigned long long value = 0;
+        try
+        {
+            value = std::stoull(text, &used);
+        }
+        catch (const std::exception &)
+        {
+            used = 0;
+        }
+        if (used != text.size() || text.empty() || text[0] == '-')
+        {
+            throw std::runtime_error("invalid number in sweep: " + text);
+        }
+        return static_cast<std::size_t>(value);
+    }
+
+    /// @brief Expand a list of values and ranges, keeping the order in which they are given
+    [[nodiscard]] inline auto parse_sizes(const std::string &text) -> std::vector<std::size_t>
+    {
+        std::vector<std::size_t> values;
+        for (const std::string &item : split(text))
+        {
+            const std::vector<std::string> parts = split(item, ':');
+            if (parts.size() == 1)
+            {
+                values.push_back(to_size(parts[0]));
+                continue;
+            }
+            if (parts.size() > 3)
+            {
+                throw std::runtime_error("invalid range in sweep: " + item);
+            }
+
+            const std::size_t first = to_size(parts[0]);
+            const std::size_t last = to_size(parts[1]);
+            const std::string step = parts.size() == 3 ? parts[2] : "+1";
+            const bool multiply = step[0] == 'x' || step[0] == '*';
+            const std::size_t amount = to_size(step[0] == 'x' || step[0] == '*' || step[0] == '+' ? step.substr(1) : step);
+            if (first > last || (multiply && (amount < 2 || first == 0)) || (!multiply && amount == 0))
+            {
+                throw std::runtime_error("invalid range in sweep: " + item);
+            }
+            for (std::size_t v = first; v <= last; v = multiply ? v * amount : v + amount)
+            {
+                values.push_back(v);
+            }
+        }
+        if (values.empty())
+        {
+            throw std::runtime_error("empty sweep: " + text);
+        }
+        return values;
+    }
+
+    /// @brief True if `name` is in the comma separated list `selection`, or the list is "all"
+    [[nodiscard]] inline bool selected(const std::string &selection, const std::string &name)
+    {
+        const std::vector<std::string> names = split(selection);
+        return std::find(names.begin(), names.end(), "all") != names.end() ||
+               std::find(names.begin(), names.end(), name) != names.end();
+    }
+}
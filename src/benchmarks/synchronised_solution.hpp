@@ -1,7 +1,9 @@
 #pragma once
 
 #include "aligned_array.hpp"
+#include <algorithm>
 #include <cstring>
+#include <type_traits>
 #include <vector>
 #include <mutex>
 #include <shared_mutex>
@@ -16,17 +18,18 @@ class synchronised_solution
     aligned_array<data_type, alignment_bytes> a;
 
 public:
-    synchronised_solution(std::size_t num_blocks, std::size_t block_size)
+    synchronised_solution(std::size_t num_blocks, std::size_t block_size, const page_options &pages = {})
         : n_blocks(num_blocks),
           b_size(block_size),
           offset_write(0),
           mus(num_blocks),
-          a(num_blocks * block_size)
+          a(num_blocks * block_size, pages)
     {
     }
     ~synchronised_solution() = default;
 
     [[nodiscard]] auto size() noexcept -> std::size_t { return n_blocks * b_size; }
+    [[nodiscard]] auto backend() const noexcept -> page_backend { return a.backend(); }
 
     void fill(data_type value)
     {
@@ -62,6 +65,102 @@ public:
         }
         throw std::runtime_error("invalid pointer or block size");
     }
+
+    /// @brief Write `size / b_size` consecutive blocks, wrapping around the end of the ring.
+    /// The locks of all blocks in the batch are held for a single copy. This takes one lock per
+    /// block, not one per batch: a reader locks only the block it reads, so a batch lock would not
+    /// keep it out. The batch saves the per call checks and copies, not lock transitions
+    void write_batch(const data_type *src, std::size_t size)
+    {
+        if (src != nullptr && size > 0 && size % b_size == 0 && size <= a.size())
+        {
+            const std::size_t first = offset_write / b_size;
+            const std::size_t count = size / b_size;
+            const std::size_t head_part = std::min(size, a.size() - offset_write);
+            lock_blocks<write_lock>(first, count);
+            std::memcpy(a.offset(offset_write), src, head_part * sizeof(data_type));
+            if (head_part < size)
+            {
+                std::memcpy(a.offset(0), src + head_part, (size - head_part) * sizeof(data_type));
+            }
+            unlock_blocks<write_lock>(first, count);
+            offset_write += size;
+            offset_write = offset_write % a.size();
+            return;
+        }
+        throw std::runtime_error("invalid pointer or block size");
+    }
+
+    /// @brief Read `size / b_size` consecutive blocks starting at `offset`, wrapping around the end of the ring
+    void read_batch(data_type *dst, std::size_t size, std::size_t offset)
+    {
+        if (dst != nullptr && size > 0 && size % b_size == 0 && size <= a.size() &&
+            offset < a.size() && offset % b_size == 0)
+        {
+            const std::size_t first = offset / b_size;
+            const std::size_t count = size / b_size;
+            const std::size_t head_part = std::min(size, a.size() - offset);
+            lock_blocks<read_lock>(first, count);
+            std::memcpy(dst, a.offset(offset), head_part * sizeof(data_type));
+            if (head_part < size)
+            {
+                std::memcpy(dst + head_part, a.offset(0), (size - head_part) * sizeof(data_type));
+            }
+            unlock_blocks<read_lock>(first, count);
+            return;
+        }
+        throw std::runtime_error("invalid pointer, offset or batch size");
+    }
+
+private:
+    template <class lock_type>
+    static constexpr bool is_shared_lock = std::is_same_v<lock_type, std::shared_lock<mutex_class>>;
+
+    /// Blocks are always locked in ascending index order, so batches that wrap around
+    /// the end of the ring cannot deadlock with each other
+    template <class lock_type>
+    void lock_blocks(std::size_t first, std::size_t count)
+    {
+        const std::size_t wrapped = first + count > n_blocks ? first + count - n_blocks : 0;
+        for (std::size_t k = 0; k < wrapped; ++k)
+        {
+            lock_block<lock_type>(k);
+        }
+        for (std::size_t k = first; k < std::min(first + count, n_blocks); ++k)
+        {
+            lock_block<lock_type>(k);
+        }
+    }
+
+    template <class lock_type>
+    void unlock_blocks(std::size_t first, std::size_t count)
+    {
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            const std::size_t index = (first + k) % n_blocks;
+            if constexpr (is_shared_lock<lock_type>)
+            {
+                mus[index].unlock_shared();
+            }
+            else
+            {
+                mus[index].unlock();
+            }
+        }
+    }
+
+    template <class lock_type>
+    void lock_block(std::size_t index)
+    {
+        if constexpr (is_shared_lock<lock_type>)
+        {
+            mus[index].lock_shared();
+        }
+        else
+        {
+            mus[index].lock();
+        }
+    }
 };
 
 template <typename data_type, std::size_t alignment_bytes>
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PC_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define PC_HAS_TSC 1
+#endif
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+/// Timing source of the benchmark harness. On x86 with an invariant TSC the time stamp counter is
+/// read directly (a few ns per read instead of a clock call), converted with a factor calibrated
+/// against steady_clock. Elsewhere CLOCK_MONOTONIC_RAW or steady_clock is used. The cost of a
+/// start/stop pair is measured once and subtracted from every interval.
+
+enum class clock_source
+{
+    tsc,
+    monotonic_raw,
+    steady_clock
+};
+
+inline auto to_string(clock_source source) -> const char *
+{
+    switch (source)
+    {
+    case clock_source::tsc:
+        return "tsc";
+    case clock_source::monotonic_raw:
+        return "clock_monotonic_raw";
+    case clock_source::steady_clock:
+        return "steady_clock";
+    }
+    return "unknown";
+}
+
+struct clock_calibration
+{
+    clock_source source;
+    double ns_per_tick;
+    std::uint64_t overhead_ticks; // smallest start/stop interval observed, i.e. the cost of timing nothing
+};
+
+namespace clock_ticks
+{
+    [[nodiscard]] inline bool invariant_tsc() noexcept
+    {
+#if defined(PC_HAS_TSC) && defined(_MSC_VER)
+        int regs[4] = {};
+        __cpuid(regs, 0x80000000);
+        if (static_cast<unsigned>(regs[0]) < 0x80000007u)
+        {
+            return false;
+        }
+        __cpuid(regs, 0x80000007);
+        return (regs[3] & (1 << 8)) != 0;
+#elif defined(PC_HAS_TSC)
+        unsigned eax, ebx, ecx, edx;
+        if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0)
+        {
+            return false;
+        }
+        return (edx & (1u << 8)) != 0;
+#else
+        return false;
+#endif
+    }
+
+    [[nodiscard]] inline auto os_now() noexcept -> std::uint64_t
+    {
+#if defined(__linux__)
+        timespec ts{};
+        ::clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now().time_since_epoch())
+                                              .count());
+#endif
+    }
+
+    /// @brief Counter read before the timed code: the fences stop earlier instructions from
+    /// drifting past the read and later ones from starting before it
+    [[nodiscard]] inline auto tsc_start() noexcept -> std::uint64_t
+    {
+#if defined(PC_HAS_TSC)
+        _mm_lfence();
+        const std::uint64_t t = __rdtsc();
+        _mm_lfence();
+        return t;
+#else
+        return 0;
+#endif
+    }
+
+    /// @brief Counter read after the timed code: rdtscp waits for everything before it to finish
+    [[nodiscard]] inline auto tsc_stop() noexcept -> std::uint64_t
+    {
+#if defined(PC_HAS_TSC)
+        unsigned int aux;
+        const std::uint64_t t = __rdtscp(&aux);
+        _mm_lfence();
+        return t;
+#else
+        return 0;
+#endif
+    }
+
+    template <typename start_fn, typename stop_fn>
+    [[nodiscard]] auto measure_overhead(start_fn start, stop_fn stop) noexcept -> std::uint64_t
+    {
+        std::uint64_t overhead = ~std::uint64_t{0};
+        for (int k = 0; k < 1000; ++k)
+        {
+            const std::uint64_t t0 = start();
+            const std::uint64_t t1 = stop();
+            overhead = std::min(overhead, t1 - t0);
+        }
+        return overhead;
+    }
+
+    [[nodiscard]] inline auto calibrate() noexcept -> clock_calibration
+    {
+        if (invariant_tsc())
+        {
+            const auto wall0 = std::chrono::steady_clock::now();
+            const std::uint64_t tsc0 = tsc_start();
+            std::chrono::steady_clock::duration elapsed;
+            do
+            {
+                elapsed = std::chrono::steady_clock::now() - wall0;
+            } while (elapsed < std::chrono::milliseconds(20));
+            const std::uint64_t tsc1 = tsc_stop();
+            const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            if (tsc1 > tsc0)
+            {
+                return {clock_source::tsc, ns / static_cast<double>(tsc1 - tsc0), measure_overhead(tsc_start, tsc_stop)};
+            }
+        }
+#if defined(__linux__)
+        constexpr clock_source source = clock_source::monotonic_raw;
+#else
+        constexpr clock_source source = clock_source::steady_clock;
+#endif
+        return {source, 1.0, measure_overhead(os_now, os_now)};
+    }
+
+    /// @brief Calibrated once per process, on first use
+    [[nodiscard]] inline auto calibration() noexcept -> const clock_calibration &
+    {
+        static const clock_calibration c = calibrate();
+        return c;
+    }
+}
+
+/// @brief Per-thread timer of benchmark operations. With `sample_every` = N only one operation
+/// in N is timed, the others run without touching the clock at all
+class benchmark_timer
+{
+    clock_calibration c;
+    std::size_t every;
+    std::size_t countdown;
+
+public:
+    explicit benchmark_timer(std::size_t sample_every = 1)
+        : c(clock_ticks::calibration()),
+          every(std::max<std::size_t>(sample_every, 1)),
+          countdown(0)
+    {
+    }
+
+    [[nodiscard]] auto source() const noexcept -> clock_source { return c.source; }
+    [[nodiscard]] auto sample_every() const noexcept -> std::size_t { return every; }
+
+    /// @brief True if the next operation is to be timed
+    [[nodiscard]] bool sample() noexcept
+    {
+        if (countdown == 0)
+        {
+            countdown = every - 1;
+            return true;
+        }
+        --countdown;
+        return false;
+    }
+
+    [[nodiscard]] auto start() const noexcept -> std::uint64_t
+    {
+        return c.source == clock_source::tsc ? clock_ticks::tsc_start() : clock_ticks::os_now();
+    }
+
+    [[nodiscard]] auto stop() const noexcept -> std::uint64_t
+    {
+        return c.source == clock_source::tsc ? clock_ticks::tsc_stop() : clock_ticks::os_now();
+    }
+
+    /// @brief Nanoseconds between a start() and a stop(), net of the timer's own overhead
+    [[nodiscard]] auto elapsed_ns(std::uint64_t t0, std::uint64_t t1) const noexcept -> std::uint64_t
+    {
+        const std::uint64_t ticks = t1 - t0;
+        const std::uint64_t net = ticks > c.overhead_ticks ? ticks - c.overhead_ticks : 0;
+        return static_cast<std::uint64_t>(static_cast<double>(net) * c.ns_per_tick + 0.5);
+    }
+};
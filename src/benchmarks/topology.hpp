@@ -0,0 +1,337 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/// Placement of the writer (thread 0) and readers on the CPUs. The topology is read from
+/// /sys/devices/system/cpu on Linux; elsewhere no placement is possible and threads stay unpinned
+
+enum class placement
+{
+    none,         // wherever the scheduler puts them
+    compact,      // one thread per physical core, filling the writer's L3 domain first
+    scatter,      // one thread per physical core, round robin over the L3 domains
+    smt_siblings, // every hardware thread of a core before the next core
+    cross_l3      // readers in a different L3 domain from the writer
+};
+
+inline auto to_string(placement policy) -> std::string
+{
+    switch (policy)
+    {
+    case placement::none:
+        return "none";
+    case placement::compact:
+        return "compact";
+    case placement::scatter:
+        return "scatter";
+    case placement::smt_siblings:
+        return "smt-siblings";
+    case placement::cross_l3:
+        return "cross-l3";
+    }
+    return "unknown";
+}
+
+inline auto to_placement(const std::string &name) -> placement
+{
+    for (const placement p : {placement::none, placement::compact, placement::scatter, placement::smt_siblings, placement::cross_l3})
+    {
+        if (to_string(p) == name)
+        {
+            return p;
+        }
+    }
+    throw std::runtime_error("unknown placement: " + name);
+}
+
+/// @brief One hardware thread: its core, package and last level cache domain
+struct cpu_info
+{
+    int cpu;
+    int core;
+    int package;
+    int l3;
+};
+
+class cpu_topology
+{
+    std::vector<cpu_info> cpus;
+
+    /// @brief Parse a sysfs CPU list such as "0-3,8,10-11"
+    static auto parse_list(const std::string &text) -> std::vector<int>
+    {
+        std::vector<int> list;
+        std::size_t start = 0;
+        while (start < text.size())
+        {
+            const std::size_t end = std::min(text.find(',', start), text.size());
+            const std::string item = text.substr(start, end - start);
+            const std::size_t dash = item.find('-');
+            const int first = std::stoi(item.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            for (int k = first; k <= last; ++k)
+            {
+                list.push_back(k);
+            }
+            start = end + 1;
+        }
+        return list;
+    }
+
+    static auto read_line(const std::string &path) -> std::string
+    {
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+    static auto read_int(const std::string &path, int fallback) -> int
+    {
+        const std::string line = read_line(path);
+        return line.empty() ? fallback : std::stoi(line);
+    }
+
+    /// @brief Cores ordered by (package, l3, core), each with its hardware threads
+    auto cores() const -> std::vector<std::vector<int>>
+    {
+        std::map<std::tuple<int, int, int>, std::vector<int>> by_core;
+        for (const auto &c : cpus)
+        {
+            by_core[{c.package, c.l3, c.core}].push_back(c.cpu);
+        }
+        std::vector<std::vector<int>> ordered;
+        for (auto &[key, threads] : by_core)
+        {
+            std::sort(threads.begin(), threads.end());
+            ordered.push_back(threads);
+        }
+        return ordered;
+    }
+
+    auto info(int cpu) const -> const cpu_info &
+    {
+        return *std::find_if(cpus.begin(), cpus.end(), [cpu](const cpu_info &c)
+                             { return c.cpu == cpu; });
+    }
+
+public:
+    explicit cpu_topology(std::vector<cpu_info> hardware_threads)
+        : cpus(std::move(hardware_threads))
+    {
+        if (cpus.empty())
+        {
+            throw std::runtime_error("topology without CPUs");
+        }
+    }
+
+    /// @brief Online CPUs of this machine, read once. A CPU without an L3 cache is put in its package's domain
+    static auto system() -> const cpu_topology &
+    {
+        static const cpu_topology t = [] {
+            std::vector<cpu_info> found;
+#if defined(__linux__)
+            const std::string root = "/sys/devices/system/cpu/";
+            const std::string online = read_line(root + "online");
+            for (const int cpu : online.empty() ? std::vector<int>{} : parse_list(online))
+            {
+                const std::string dir = root + "cpu" + std::to_string(cpu) + "/";
+                const int package = read_int(dir + "topology/physical_package_id", 0);
+                int l3 = -1;
+                for (int index = 0; index < 8 && l3 < 0; ++index)
+                {
+                    const std::string cache = dir + "cache/index" + std::to_string(index) + "/";
+                    if (read_int(cache + "level", 0) == 3)
+                    {
+                        const std::string shared = read_line(cache + "shared_cpu_list");
+                        l3 = shared.empty() ? package : parse_list(shared).front(); // named after its first CPU
+                    }
+                }
+                found.push_back({cpu, read_int(dir + "topology/core_id", cpu), package, l3 < 0 ? package : l3});
+            }
+#endif
+            if (found.empty())
+            {
+                for (unsigned k = 0; k < std::max(std::thread::hardware_concurrency(), 1u); ++k)
+                {
+                    found.push_back({static_cast<int>(k), static_cast<int>(k), 0, 0});
+                }
+            }
+            return cpu_topology(found);
+        }();
+        return t;
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return cpus.size(); }
+
+    [[nodiscard]] auto l3_domains() const -> std::size_t
+    {
+        std::set<std::pair<int, int>> domains;
+        for (const auto &c : cpus)
+        {
+            domains.insert({c.package, c.l3});
+        }
+        return domains.size();
+    }
+
+    /// @brief CPU of every thread, the writer first; -1 leaves a thread unpinned. Policies that run
+    /// out of CPUs start over from the beginning of their order
+    [[nodiscard]] auto assign(placement policy, std::size_t threads) const -> std::vector<int>
+    {
+        if (policy == placement::none)
+        {
+            return std::vector<int>(threads, -1);
+        }
+
+        std::vector<std::vector<int>> ordered = cores();
+        if (policy == placement::smt_siblings)
+        {
+            return cycle(siblings_together(ordered), threads);
+        }
+        if (policy == placement::compact)
+        {
+            return cycle(cores_first(ordered), threads);
+        }
+        const std::vector<std::vector<std::vector<int>>> domains = by_domain(ordered);
+        if (policy == placement::cross_l3 && domains.size() > 1)
+        {
+            std::vector<std::vector<int>> others;
+            for (std::size_t d = 1; d < domains.size(); ++d)
+            {
+                others.insert(others.end(), domains[d].begin(), domains[d].end());
+            }
+            std::vector<int> cpus_of_threads = cycle(cores_first(others), threads);
+            if (!cpus_of_threads.empty())
+            {
+                cpus_of_threads.insert(cpus_of_threads.begin(), domains.front().front().front());
+                cpus_of_threads.pop_back();
+            }
+            return cpus_of_threads;
+        }
+
+        // scatter, and cross_l3 on a machine with a single L3 domain
+        std::vector<std::vector<int>> round_robin;
+        for (std::size_t k = 0; round_robin.size() < ordered.size(); ++k)
+        {
+            for (const auto &domain : domains)
+            {
+                if (k < domain.size())
+                {
+                    round_robin.push_back(domain[k]);
+                }
+            }
+        }
+        return cycle(cores_first(round_robin), threads);
+    }
+
+private:
+    /// @brief Every hardware thread of a core before the next core
+    static auto siblings_together(const std::vector<std::vector<int>> &list) -> std::vector<int>
+    {
+        std::vector<int> order;
+        for (const auto &core : list)
+        {
+            order.insert(order.end(), core.begin(), core.end());
+        }
+        return order;
+    }
+
+    /// @brief The first hardware thread of every core, then the second one and so on
+    static auto cores_first(const std::vector<std::vector<int>> &list) -> std::vector<int>
+    {
+        std::vector<int> order;
+        std::size_t total{0};
+        for (const auto &core : list)
+        {
+            total += core.size();
+        }
+        for (std::size_t sibling = 0; order.size() < total; ++sibling)
+        {
+            for (const auto &core : list)
+            {
+                if (sibling < core.size())
+                {
+                    order.push_back(core[sibling]);
+                }
+            }
+        }
+        return order;
+    }
+
+    /// @brief Cores grouped by (package, l3) domain, keeping their order
+    auto by_domain(const std::vector<std::vector<int>> &list) const -> std::vector<std::vector<std::vector<int>>>
+    {
+        std::vector<std::vector<std::vector<int>>> domains;
+        std::vector<std::pair<int, int>> keys;
+        for (const auto &core : list)
+        {
+            const cpu_info &c = info(core.front());
+            const auto key = std::make_pair(c.package, c.l3);
+            const auto it = std::find(keys.begin(), keys.end(), key);
+            if (it == keys.end())
+            {
+                keys.push_back(key);
+                domains.push_back({core});
+            }
+            else
+            {
+                domains[static_cast<std::size_t>(it - keys.begin())].push_back(core);
+            }
+        }
+        return domains;
+    }
+
+    static auto cycle(const std::vector<int> &order, std::size_t threads) -> std::vector<int>
+    {
+        std::vector<int> assigned(threads);
+        for (std::size_t k = 0; k < threads; ++k)
+        {
+            assigned[k] = order[k % order.size()];
+        }
+        return assigned;
+    }
+};
+
+/// @brief Comma separated CPUs of a placement, "-" for an unpinned thread
+inline auto cpu_list(const std::vector<int> &cpus) -> std::string
+{
+    std::string s;
+    for (const int cpu : cpus)
+    {
+        s += (s.empty() ? "" : ",") + (cpu < 0 ? std::string("-") : std::to_string(cpu));
+    }
+    return s;
+}
+
+/// @brief Restrict a running thread to one CPU, false if that is not possible on this platform
+inline bool pin_thread(std::thread &thread, int cpu)
+{
+    if (cpu < 0)
+    {
+        return true;
+    }
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)thread;
+    return false;
+#endif
+}
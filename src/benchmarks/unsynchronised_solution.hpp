@@ -13,16 +13,17 @@ class unsynchronised_solution
     storage a;
 
 public:
-    unsynchronised_solution(std::size_t num_blocks, std::size_t block_size)
+    unsynchronised_solution(std::size_t num_blocks, std::size_t block_size, const page_options &pages = {})
         : n_blocks(num_blocks),
           b_size(block_size),
           offset_write(0),
-          a(num_blocks * block_size)
+          a(num_blocks * block_size, pages)
     {
     }
     ~unsynchronised_solution() = default;
 
     [[nodiscard]] auto size() noexcept -> std::size_t { return n_blocks * b_size; }
+    [[nodiscard]] auto backend() const noexcept -> page_backend { return a.backend(); }
 
     void fill(data_type value)
     {
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "aligned_array.hpp"
+#include "benchmark.hpp"
+#include "latency_histogram.hpp"
+#include "timer.hpp"
+#include "variable_solution.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cmath>
+#include <latch>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// @brief Distribution of frame lengths produced by the variable-length writer
+struct frame_distribution
+{
+    enum class shape
+    {
+        fixed,      // every frame has max_size elements
+        uniform,    // uniform in [min_size, max_size]
+        normal,     // normal with the given mean and stddev, clamped to [min_size, max_size]
+        exponential // min_size plus an exponential tail with the given mean, clamped to max_size
+    };
+
+    shape kind{shape::uniform};
+    std::size_t min_size{1};
+    std::size_t max_size{16};
+    double mean{0.0};   // normal and exponential only, defaults to the middle of the range
+    double stddev{0.0}; // normal only, defaults to a sixth of the range
+    unsigned int seed{12345};
+
+    [[nodiscard]] auto name() const -> std::string
+    {
+        switch (kind)
+        {
+        case shape::fixed:
+            return "fixed";
+        case shape::uniform:
+            return "uniform";
+        case shape::normal:
+            return "normal";
+        case shape::exponential:
+            return "exponential";
+        }
+        return "unknown";
+    }
+
+    /// @brief Draw `count` frame lengths. Generated up front so the RNG stays out of the timed loop
+    [[nodiscard]] auto generate(std::size_t count) const -> std::vector<std::size_t>
+    {
+        if (min_size == 0 || min_size > max_size)
+        {
+            throw std::runtime_error("invalid frame size range");
+        }
+        std::mt19937_64 rng(seed);
+        const double mid = mean > 0.0 ? mean : 0.5 * static_cast<double>(min_size + max_size);
+        const double spread = stddev > 0.0 ? stddev : static_cast<double>(max_size - min_size) / 6.0;
+        const auto clamp = [this](double v)
+        {
+            return std::clamp(static_cast<std::size_t>(std::max(std::llround(v), 0LL)), min_size, max_size);
+        };
+
+        std::vector<std::size_t> sizes(count);
+        switch (kind)
+        {
+        case shape::fixed:
+            std::fill(sizes.begin(), sizes.end(), max_size);
+            break;
+        case shape::uniform:
+        {
+            std::uniform_int_distribution<std::size_t> d(min_size, max_size);
+            std::generate(sizes.begin(), sizes.end(), [&]
+                          { return d(rng); });
+            break;
+        }
+        case shape::normal:
+        {
+            std::normal_distribution<double> d(mid, std::max(spread, 1e-9));
+            std::generate(sizes.begin(), sizes.end(), [&]
+                          { return clamp(d(rng)); });
+            break;
+        }
+        case shape::exponential:
+        {
+            std::exponential_distribution<double> d(1.0 / std::max(mid - static_cast<double>(min_size), 1.0));
+            std::generate(sizes.begin(), sizes.end(), [&]
+                          { return clamp(static_cast<double>(min_size) + d(rng)); });
+            break;
+        }
+        }
+        return sizes;
+    }
+};
+
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void variable_writer(solution &store,
+                     const std::vector<std::size_t> &sizes,
+                     std::size_t sample_every,
+                     std::latch &thread_latch,
+                     double &write_time_ns,
+                     latency_histogram &histogram)
+{
+    spdlog::info("Variable writer starts");
+
+    data_type value{0};
+    aligned_array<data_type, alignment_bytes> src(store.max_frame_size());
+
+    fill_array(src, value++);
+    store.write(src.data(), sizes[0]);
+
+    thread_latch.arrive_and_wait();
+
+    benchmark_timer timer(sample_every);
+    write_time_ns = 0;
+    std::size_t timed{0};
+    for (size_t k = 1; k < sizes.size(); ++k)
+    {
+        fill_array(src, value++);
+        if (timer.sample())
+        {
+            const std::uint64_t t0 = timer.start();
+            store.write(src.data(), sizes[k]);
+            const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+            write_time_ns += static_cast<double>(ns);
+            histogram.record(ns);
+            ++timed;
+        }
+        else
+        {
+            store.write(src.data(), sizes[k]);
+        }
+    }
+
+    write_time_ns = timed > 0 ? write_time_ns / timed : 0.0;
+    spdlog::info("Variable writer terminates. Write time, ns: {:.1f}", write_time_ns);
+}
+
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void variable_reader(solution &store,
+                     std::size_t cycles,
+                     std::size_t index,
+                     std::size_t sample_every,
+                     std::latch &thread_latch,
+                     double &read_time_ns,
+                     std::size_t &lost_frames,
+                     latency_histogram &histogram)
+{
+    spdlog::info("Variable reader {} starts", index);
+
+    aligned_array<data_type, alignment_bytes> dst(store.max_frame_size());
+    frame_cursor consumer;
+    benchmark_timer timer(sample_every);
+    thread_latch.arrive_and_wait();
+    read_time_ns = 0;
+    std::size_t received{0};
+    std::size_t timed{0};
+
+    while (consumer.next < cycles)
+    {
+        if (timer.sample())
+        {
+            const std::uint64_t t0 = timer.start();
+            const frame_result result = store.read_next(dst.data(), dst.size(), consumer);
+            const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+            if (result.status == read_status::ok)
+            {
+                read_time_ns += static_cast<double>(ns);
+                histogram.record(ns);
+                ++received;
+                ++timed;
+            }
+        }
+        else if (store.read_next(dst.data(), dst.size(), consumer).status == read_status::ok)
+        {
+            ++received;
+        }
+    }
+
+    read_time_ns = timed > 0 ? read_time_ns / timed : 0.0;
+    lost_frames = consumer.lost;
+    spdlog::info("Variable reader {} terminates. Read time, ns: {:.1f}, received: {}, lost: {}",
+                 index, read_time_ns, received, lost_frames);
+}
+
+/// @param num_blocks ring capacity in frames of the maximum size
+/// @param frames distribution of frame lengths, frames.max_size is the maximum frame length
+template <typename data_type, std::size_t alignment_bytes>
+benchmark_results run_variable_benchmark(std::size_t num_blocks,
+                                         const frame_distribution &frames,
+                                         std::size_t num_readers,
+                                         std::size_t cycles,
+                                         std::size_t sample_every = 1)
+{
+    using solution = variable_solution<data_type, alignment_bytes>;
+    solution store(num_blocks, frames.max_size);
+    const std::vector<std::size_t> sizes = frames.generate(cycles);
+
+    std::latch thread_latch(num_readers + 1);
+    benchmark_results results{std::vector<double>(num_readers + 1), std::vector<std::size_t>(num_readers)};
+    results.labels.emplace_back("clock_source", to_string(clock_ticks::calibration().source));
+    std::vector<double> &times = results.times;
+
+    std::thread writer_thread(variable_writer<solution, data_type, alignment_bytes>,
+                              std::ref(store),
+                              std::cref(sizes),
+                              sample_every,
+                              std::ref(thread_latch),
+                              std::ref(times[0]),
+                              std::ref(results.write_latency));
+
+    std::vector<latency_histogram> histograms(num_readers);
+    std::vector<std::thread> readers;
+    for (std::size_t k = 0; k < num_readers; ++k)
+    {
+        readers.emplace_back(variable_reader<solution, data_type, alignment_bytes>,
+                             std::ref(store),
+                             cycles,
+                             k,
+                             sample_every,
+                             std::ref(thread_latch),
+                             std::ref(times[k + 1]),
+                             std::ref(results.lost[k]),
+                             std::ref(histograms[k]));
+    }
+
+    writer_thread.join();
+    for (auto &r : readers)
+    {
+        r.join();
+    }
+    for (const auto &h : histograms)
+    {
+        results.read_latency.merge(h);
+    }
+
+    double total{0.0};
+    for (const auto s : sizes)
+    {
+        total += static_cast<double>(s);
+    }
+    results.metrics.emplace_back("mean_frame_size", total / static_cast<double>(sizes.size()));
+    return results;
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include "aligned_array.hpp"
+#include "consumer.hpp"
+#include "seqlock_solution.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+/// @brief Read position of a consumer of variable_solution
+struct frame_cursor : consumer_cursor
+{
+    std::size_t position{0}; // monotonic word position of the record with sequence number `next`
+};
+
+/// @brief Outcome of a single variable_solution::read_next call
+struct frame_result
+{
+    read_status status;
+    std::size_t lost; // frames overwritten by the writer before this consumer could read them
+    std::size_t size; // number of elements copied into the destination buffer
+};
+
+/// @brief SPMC ring of variable-length frames. Each frame is stored as a record made of a two-word
+/// header (sequence number, length in elements) followed by the payload, padded so that every
+/// record starts on an `alignment_bytes` boundary. A record never straddles the end of the ring:
+/// when it does not fit, the writer leaves a wrap marker and continues from the start of the ring.
+///
+/// Before overwriting old records the writer moves the tail (oldest intact record) past them.
+/// Readers validate each record against its expected sequence number and re-check the tail after
+/// the copy, so overwritten frames are discarded and reported as lost. Payload and headers are
+/// accessed with relaxed atomics, so there are no data races between the writer and the readers.
+template <typename data_type, std::size_t alignment_bytes>
+    requires(alignment_bytes >= 2 * sizeof(std::uint64_t) && alignment_bytes % sizeof(std::uint64_t) == 0)
+class variable_solution
+{
+    using word = std::uint64_t;
+    static constexpr std::size_t word_bytes = sizeof(word);
+    static constexpr std::size_t header_words = 2;
+    static constexpr std::size_t align_words = alignment_bytes / word_bytes;
+    static constexpr word wrap_marker = std::numeric_limits<word>::max();
+
+    struct alignas(128) tail_state
+    {
+        std::atomic<std::size_t> version{0}; // odd while seq and position are being updated
+        std::atomic<std::size_t> seq{0};
+        std::atomic<std::size_t> position{0};
+    };
+
+    std::size_t max_size;
+    std::size_t capacity;
+    cursor<> published;
+    tail_state tail;
+    std::size_t write_position;
+    std::size_t write_seq;
+    std::size_t tail_seq;
+    std::size_t tail_position;
+    aligned_array<word, alignment_bytes> a;
+
+public:
+    /// @param num_blocks ring capacity expressed in frames of the maximum length
+    /// @param block_size maximum frame length in elements
+    variable_solution(std::size_t num_blocks, std::size_t block_size)
+        : max_size(block_size),
+          capacity(round_up(num_blocks * block_size * sizeof(data_type) / word_bytes, align_words)),
+          published{0},
+          write_position(0),
+          write_seq(0),
+          tail_seq(0),
+          tail_position(0),
+          a(capacity)
+    {
+        if (block_size == 0 || record_words(block_size) > capacity)
+        {
+            throw std::runtime_error("ring is too small for the maximum frame size");
+        }
+        fill_array(a, word{0});
+    }
+    ~variable_solution() = default;
+
+    [[nodiscard]] auto max_frame_size() const noexcept -> std::size_t { return max_size; }
+
+    /// @brief Number of frames written so far
+    [[nodiscard]] auto head() const noexcept -> std::size_t { return published.seq.load(std::memory_order_acquire); }
+
+    void write(const data_type *src, std::size_t size)
+    {
+        if (src != nullptr && size > 0 && size <= max_size)
+        {
+            const std::size_t record = record_words(size);
+            std::size_t offset = write_position % capacity;
+            const std::size_t padding = offset + record > capacity ? capacity - offset : 0;
+
+            reclaim(write_position + padding, write_position + padding + record);
+            if (padding > 0)
+            {
+                store_word(offset, write_seq);
+                store_word(offset + 1, wrap_marker);
+                write_position += padding;
+                offset = 0;
+            }
+            store_word(offset, write_seq);
+            store_word(offset + 1, size);
+            store_payload(offset + header_words, src, size * sizeof(data_type));
+
+            write_position += record;
+            ++write_seq;
+            published.seq.store(write_seq, std::memory_order_release);
+            return;
+        }
+        throw std::runtime_error("invalid pointer or frame size");
+    }
+
+    /// @brief Read the oldest frame the consumer has not seen yet into `dst`, which must hold at least
+    /// max_frame_size() elements. Frames overwritten before the consumer got to them are skipped
+    auto read_next(data_type *dst, std::size_t dst_size, frame_cursor &consumer) -> frame_result
+    {
+        if (dst != nullptr && dst_size >= max_size)
+        {
+            std::size_t lost{0};
+            while (true)
+            {
+                if (consumer.next >= published.seq.load(std::memory_order_acquire))
+                {
+                    return {read_status::not_ready, lost, 0};
+                }
+                // a consumer at a wrap marker that the writer has reclaimed is behind the tail with the same sequence
+                if (consumer.next < tail.seq.load(std::memory_order_acquire) ||
+                    consumer.position < tail.position.load(std::memory_order_acquire))
+                {
+                    const std::size_t skipped_to = resynchronise(consumer);
+                    lost += skipped_to - consumer.next;
+                    consumer.next = skipped_to;
+                    continue;
+                }
+
+                const std::size_t offset = consumer.position % capacity;
+                const word seq = load_word(offset);
+                const word length = load_word(offset + 1);
+                const bool valid_header = seq == consumer.next &&
+                                          (length == wrap_marker ||
+                                           (length > 0 && length <= max_size && offset + record_words(length) <= capacity));
+                if (valid_header && length != wrap_marker)
+                {
+                    load_payload(dst, offset + header_words, length * sizeof(data_type));
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (!valid_header || consumer.next < tail.seq.load(std::memory_order_relaxed))
+                {
+                    // the record was overwritten, the tail has moved past it
+                    continue;
+                }
+
+                if (length == wrap_marker)
+                {
+                    consumer.position += capacity - offset;
+                    continue;
+                }
+                consumer.position += record_words(length);
+                ++consumer.next;
+                consumer.lost += lost;
+                return {read_status::ok, lost, length};
+            }
+        }
+        throw std::runtime_error("invalid pointer or buffer size");
+    }
+
+private:
+    [[nodiscard]] static constexpr auto round_up(std::size_t value, std::size_t multiple) noexcept -> std::size_t
+    {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    [[nodiscard]] static constexpr auto record_words(std::size_t size) noexcept -> std::size_t
+    {
+        return round_up(header_words + round_up(size * sizeof(data_type), word_bytes) / word_bytes, align_words);
+    }
+
+    /// @brief Advance the tail past every record that overlaps the words up to `end` and publish it
+    /// before any of those words are overwritten. The new record starts at `first`. If it also
+    /// covers the wrap marker in front of it, no older record survives and the new one becomes the tail
+    void reclaim(std::size_t first, std::size_t end)
+    {
+        if (end - tail_position <= capacity)
+        {
+            return;
+        }
+
+        if (end - write_position > capacity)
+        {
+            tail_position = first;
+            tail_seq = write_seq;
+        }
+        else
+        {
+            // `end - write_position` fits in the ring, so the walk stops at write_position at the latest
+            while (end - tail_position > capacity)
+            {
+                const std::size_t offset = tail_position % capacity;
+                const word length = load_word(offset + 1);
+                if (length == wrap_marker)
+                {
+                    tail_position += capacity - offset;
+                }
+                else
+                {
+                    tail_position += record_words(length);
+                    ++tail_seq;
+                }
+            }
+        }
+        const std::size_t version = tail.version.load(std::memory_order_relaxed);
+        tail.version.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        tail.position.store(tail_position, std::memory_order_relaxed);
+        tail.seq.store(tail_seq, std::memory_order_release);
+        tail.version.store(version + 2, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /// @brief Move the consumer to the oldest intact record, returns its sequence number
+    auto resynchronise(frame_cursor &consumer) -> std::size_t
+    {
+        std::size_t version0;
+        std::size_t version1;
+        std::size_t seq;
+        do
+        {
+            version0 = tail.version.load(std::memory_order_acquire);
+            seq = tail.seq.load(std::memory_order_relaxed);
+            consumer.position = tail.position.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            version1 = tail.version.load(std::memory_order_relaxed);
+        } while (version0 != version1 || version0 & 1);
+        return seq;
+    }
+
+    void store_word(std::size_t index, word value) noexcept
+    {
+        std::atomic_ref<word>(a.data()[index]).store(value, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto load_word(std::size_t index) const noexcept -> word
+    {
+        return std::atomic_ref<word>(a.data()[index]).load(std::memory_order_relaxed);
+    }
+
+    void store_payload(std::size_t index, const void *src, std::size_t bytes) noexcept
+    {
+        const auto *s = static_cast<const unsigned char *>(src);
+        for (std::size_t k = 0; k < bytes; k += word_bytes)
+        {
+            word value{0};
+            std::memcpy(&value, s + k, std::min(word_bytes, bytes - k));
+            store_word(index++, value);
+        }
+    }
+
+    void load_payload(void *dst, std::size_t index, std::size_t bytes) const noexcept
+    {
+        auto *d = static_cast<unsigned char *>(dst);
+        for (std::size_t k = 0; k < bytes; k += word_bytes)
+        {
+            const word value = load_word(index++);
+            std::memcpy(d + k, &value, std::min(word_bytes, bytes - k));
+        }
+    }
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "aligned_array.hpp"
+#include "benchmark.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <latch>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+/// @brief CPU time consumed by the calling thread, ns. Zero where the platform does not expose it
+inline auto thread_cpu_time_ns() noexcept -> std::uint64_t
+{
+#if defined(__linux__) || defined(__APPLE__)
+    timespec ts{};
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+#else
+    return 0;
+#endif
+}
+
+inline auto steady_now_ns() noexcept -> std::uint64_t
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now().time_since_epoch())
+                                          .count());
+}
+
+/// @brief Writer publishing one block every `interval_ns`, so that consumers actually run out of
+/// data and have to wait. The first element of every block carries its publication time
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void paced_writer(solution &store,
+                  std::size_t block_size,
+                  std::size_t cycles,
+                  std::uint64_t interval_ns,
+                  std::latch &thread_latch,
+                  double &write_time_ns)
+{
+    spdlog::info("Paced writer starts, interval {} ns", interval_ns);
+
+    aligned_array<data_type, alignment_bytes> src(block_size);
+    fill_array(src, data_type{0});
+    thread_latch.arrive_and_wait();
+
+    write_time_ns = 0;
+    std::uint64_t deadline = steady_now_ns();
+    for (std::size_t k = 0; k < cycles; ++k)
+    {
+        deadline += interval_ns;
+        while (steady_now_ns() < deadline)
+        {
+        }
+        const auto t0 = std::chrono::high_resolution_clock::now();
+        src.data()[0] = static_cast<data_type>(steady_now_ns());
+        store.write(src.data(), block_size);
+        const auto dt = std::chrono::high_resolution_clock::now() - t0;
+        write_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count();
+    }
+
+    write_time_ns = write_time_ns / cycles;
+    spdlog::info("Paced writer terminates. Write time, ns: {:.1f}", write_time_ns);
+}
+
+/// @brief Consumer that waits for every block with the solution's wait policy and measures the
+/// latency from publication to the end of the copy, together with its own CPU usage
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+void waiting_reader(solution &store,
+                    std::size_t block_size,
+                    std::size_t cycles,
+                    std::size_t index,
+                    std::latch &thread_latch,
+                    double &latency_ns,
+                    double &cpu_percent,
+                    std::size_t &lost_blocks)
+{
+    spdlog::info("Waiting reader {} starts", index);
+
+    aligned_array<data_type, alignment_bytes> dst(block_size);
+    consumer_cursor consumer;
+    thread_latch.arrive_and_wait();
+
+    const std::uint64_t wall0 = steady_now_ns();
+    const std::uint64_t cpu0 = thread_cpu_time_ns();
+    double total_latency{0};
+    std::size_t received{0};
+    while (consumer.next < cycles)
+    {
+        store.wait(consumer.next);
+        const read_result result = store.read_next(dst.data(), block_size, consumer);
+        if (result.status == read_status::ok)
+        {
+            total_latency += static_cast<double>(steady_now_ns() - static_cast<std::uint64_t>(dst.data()[0]));
+            ++received;
+        }
+    }
+    const std::uint64_t cpu = thread_cpu_time_ns() - cpu0;
+    const std::uint64_t wall = std::max<std::uint64_t>(steady_now_ns() - wall0, 1);
+
+    latency_ns = received > 0 ? total_latency / received : 0.0;
+    cpu_percent = 100.0 * static_cast<double>(cpu) / static_cast<double>(wall);
+    lost_blocks = consumer.lost;
+    spdlog::info("Waiting reader {} terminates. Latency, ns: {:.1f}, CPU: {:.1f}%, lost: {}",
+                 index, latency_ns, cpu_percent, lost_blocks);
+}
+
+/// @brief Latency versus CPU usage of a solution's wait policy. Reader times are the mean
+/// publication-to-read latency; the mean reader CPU usage is reported as `reader_cpu_percent`
+template <typename solution, typename data_type, std::size_t alignment_bytes>
+    requires(std::is_integral_v<data_type> && sizeof(data_type) >= sizeof(std::uint64_t))
+benchmark_results run_wait_benchmark(std::size_t num_blocks,
+                                     std::size_t block_size,
+                                     std::size_t num_readers,
+                                     std::size_t cycles,
+                                     std::uint64_t interval_ns)
+{
+    solution store(num_blocks, block_size);
+    store.fill(data_type{0});
+
+    std::latch thread_latch(num_readers + 1);
+    benchmark_results results{std::vector<double>(num_readers + 1), std::vector<std::size_t>(num_readers)};
+    std::vector<double> &times = results.times;
+    std::vector<double> cpu(num_readers);
+
+    std::thread writer_thread(paced_writer<solution, data_type, alignment_bytes>,
+                              std::ref(store),
+                              block_size,
+                              cycles,
+                              interval_ns,
+                              std::ref(thread_latch),
+                              std::ref(times[0]));
+
+    std::vector<std::thread> readers;
+    for (std::size_t k = 0; k < num_readers; ++k)
+    {
+        readers.emplace_back(waiting_reader<solution, data_type, alignment_bytes>,
+                             std::ref(store),
+                             block_size,
+                             cycles,
+                             k,
+                             std::ref(thread_latch),
+                             std::ref(times[k + 1]),
+                             std::ref(cpu[k]),
+                             std::ref(results.lost[k]));
+    }
+
+    writer_thread.join();
+    for (auto &r : readers)
+    {
+        r.join();
+    }
+
+    double total_cpu{0};
+    for (const auto c : cpu)
+    {
+        total_cpu += c;
+    }
+    results.metrics.emplace_back("reader_cpu_percent", num_readers > 0 ? total_cpu / num_readers : 0.0);
+    results.metrics.emplace_back("interval_ns", static_cast<double>(interval_ns));
+    return results;
+}
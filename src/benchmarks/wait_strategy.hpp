@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define PC_HAS_MM_PAUSE 1
+#endif
+
+/// Wait strategies used by consumers waiting for the writer to publish the next block.
+/// `wait` returns once `value` no longer holds `old` (it may also return spuriously, callers
+/// re-check their condition). `notify` is called by the writer after every publication and
+/// only wakes consumers that are actually parked, tracked by the shared `parked` counter.
+
+/// @brief Tell the core we are spinning: frees pipeline resources for the sibling hyper-thread
+inline void cpu_relax() noexcept
+{
+#if defined(PC_HAS_MM_PAUSE)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+/// @brief Spin on `ready` with a pause, yielding every `spins` attempts so that waiting
+/// threads cannot starve the one they wait for on an oversubscribed machine
+template <typename predicate>
+void spin_until(predicate ready, std::size_t spins = 256) noexcept
+{
+    for (std::size_t k = 1; !ready(); ++k)
+    {
+        if (k % spins == 0)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            cpu_relax();
+        }
+    }
+}
+
+/// @brief Burn the core until the value changes. Lowest latency, one full core per consumer
+struct busy_spin
+{
+    static constexpr const char *name = "spin";
+
+    template <typename T>
+    static void wait(const std::atomic<T> &value, T old, std::atomic<std::size_t> &) noexcept
+    {
+        while (value.load(std::memory_order_acquire) == old)
+        {
+            cpu_relax();
+        }
+    }
+
+    template <typename T>
+    static void notify(std::atomic<T> &, std::atomic<std::size_t> &) noexcept
+    {
+    }
+};
+
+/// @brief Spin for a bounded number of iterations, then give the core away with yield between checks
+template <std::size_t spins = 256>
+struct spin_yield
+{
+    static constexpr const char *name = "spin-yield";
+
+    template <typename T>
+    static void wait(const std::atomic<T> &value, T old, std::atomic<std::size_t> &) noexcept
+    {
+        for (std::size_t k = 0; value.load(std::memory_order_acquire) == old; ++k)
+        {
+            if (k < spins)
+            {
+                cpu_relax();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    template <typename T>
+    static void notify(std::atomic<T> &, std::atomic<std::size_t> &) noexcept
+    {
+    }
+};
+
+/// @brief Spin for a bounded number of iterations, then park in the kernel with std::atomic::wait
+/// (a futex on Linux). The writer pays for a wake-up system call only while someone is parked
+template <std::size_t spins = 256>
+struct futex_park
+{
+    static constexpr const char *name = "futex";
+
+    template <typename T>
+    static void wait(const std::atomic<T> &value, T old, std::atomic<std::size_t> &parked) noexcept
+    {
+        for (std::size_t k = 0; k < spins; ++k)
+        {
+            if (value.load(std::memory_order_acquire) != old)
+            {
+                return;
+            }
+            cpu_relax();
+        }
+        // pairs with the fence in notify: either the writer sees parked > 0, or we see the new value
+        parked.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        value.wait(old, std::memory_order_acquire);
+        parked.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    template <typename T>
+    static void notify(std::atomic<T> &value, std::atomic<std::size_t> &parked) noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed) > 0)
+        {
+            value.notify_all();
+        }
+    }
+};
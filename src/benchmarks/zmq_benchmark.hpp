@@ -1,114 +1,566 @@
 #pragma once
 
 #include "aligned_array.hpp"
+#include "benchmark.hpp"
+#include "seqlock_solution.hpp"
+#include "timer.hpp"
+#include "wait_strategy.hpp"
 
 #include <zmq.hpp>
 #include <zmq_addon.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <vector>
 #include <thread>
 #include <barrier>
 #include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
 #include <spdlog/spdlog.h>
 #include <spdlog/fmt/fmt.h>
 
+/// ZeroMQ publish/subscribe measured like the other implementations: the same number of blocks,
+/// every block sent without a copy and read into a private buffer. The writer publishes
+/// zmq::message_t objects pointing into a pool of `num_blocks` blocks, two at least. ZeroMQ hands the block back
+/// through the message's free function once every subscriber is done with it, and the writer
+/// waits for a block to come back before reusing it, so the pool plays the part of the ring.
+///
+/// Messages shorter than a block are control messages. An empty message greets the subscribers:
+/// the writer repeats it until every subscriber has received one, so none of them misses the
+/// first blocks while it is still joining. A one byte message ends the stream, and the writer
+/// repeats it until every reader has stopped, since PUB sockets drop messages at the high water mark.
+/// The first element of every block is its sequence number, and gaps in it are reported as lost
+
+enum class zmq_transport
+{
+    inproc,
+    ipc,
+    tcp
+};
+
+inline auto to_string(zmq_transport transport) -> const char *
+{
+    switch (transport)
+    {
+    case zmq_transport::inproc:
+        return "inproc";
+    case zmq_transport::ipc:
+        return "ipc";
+    case zmq_transport::tcp:
+        return "tcp";
+    }
+    return "unknown";
+}
+
+inline auto to_zmq_transport(const std::string &name) -> zmq_transport
+{
+    for (const auto transport : {zmq_transport::inproc, zmq_transport::ipc, zmq_transport::tcp})
+    {
+        if (name == to_string(transport))
+        {
+            return transport;
+        }
+    }
+    throw std::runtime_error("unknown ZeroMQ transport: " + name);
+}
+
+struct zmq_options
+{
+    zmq_transport transport{zmq_transport::inproc};
+    int high_water_mark{1000}; // messages queued per subscriber before the publisher drops them
+    bool conflate{false};      // subscribers keep only the newest message
+};
+
+/// @brief Blocks lent to ZeroMQ messages. A block is busy from acquire() until ZeroMQ calls the free function of its message
 template <typename data_type, std::size_t alignment_bytes>
-void zmq_writer(zmq::context_t &ctx,
-                std::size_t block_size,
+class zmq_block_pool
+{
+public:
+    /// A subscriber only drops its last message when it receives the next one, so with a single
+    /// block the writer would wait for a block that cannot come back until the writer sends again
+    static constexpr std::size_t min_blocks = 2;
+
+private:
+    std::size_t b_size;
+    std::vector<cursor<>> busy;
+    aligned_array<data_type, alignment_bytes> blocks;
+
+    static void release(void *, void *hint) noexcept
+    {
+        static_cast<std::atomic<std::size_t> *>(hint)->store(0, std::memory_order_release);
+    }
+
+public:
+    zmq_block_pool(std::size_t num_blocks, std::size_t block_size)
+        : b_size(block_size),
+          busy(num_blocks),
+          blocks(num_blocks * block_size)
+    {
+        if (num_blocks < min_blocks)
+        {
+            throw std::runtime_error("a ZeroMQ block pool needs at least two blocks");
+        }
+    }
+
+    [[nodiscard]] auto block_size() const noexcept -> std::size_t { return b_size; }
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return busy.size(); }
+
+    /// @brief Wait until block `index` is back from ZeroMQ and lend it out again
+    auto acquire(std::size_t index) noexcept -> data_type *
+    {
+        auto &flag = busy[index].seq;
+        spin_until([&flag]
+                   { return flag.load(std::memory_order_acquire) == 0; });
+        flag.store(1, std::memory_order_relaxed);
+        return blocks.offset(index * b_size);
+    }
+
+    /// @brief Message pointing at block `index`, which must have been acquired
+    auto message(std::size_t index) -> zmq::message_t
+    {
+        return zmq::message_t(blocks.offset(index * b_size), b_size * sizeof(data_type), &release, &busy[index].seq);
+    }
+};
+
+/// @brief Bind the publisher for `options` and return the endpoint subscribers connect to
+inline auto bind_publisher(zmq::socket_t &publisher, const zmq_options &options) -> std::string
+{
+    publisher.set(zmq::sockopt::sndhwm, options.high_water_mark);
+    publisher.set(zmq::sockopt::linger, 0);
+    switch (options.transport)
+    {
+    case zmq_transport::inproc:
+        publisher.bind("inproc://benchmark");
+        break;
+    case zmq_transport::ipc:
+        publisher.bind(fmt::format("ipc://{}", (std::filesystem::temp_directory_path() / "producer-consumer-benchmark.ipc").string()));
+        break;
+    case zmq_transport::tcp:
+        publisher.bind("tcp://127.0.0.1:*");
+        break;
+    }
+    return publisher.get(zmq::sockopt::last_endpoint);
+}
+
+/// @brief Connect a subscriber to every message of `endpoint` and wait for the writer's greeting
+inline void join_publisher(zmq::socket_t &subscriber, const std::string &endpoint, const zmq_options &options, std::atomic<std::size_t> &joined)
+{
+    subscriber.set(zmq::sockopt::rcvhwm, options.high_water_mark);
+    if (options.conflate)
+    {
+        subscriber.set(zmq::sockopt::conflate, true);
+    }
+    subscriber.connect(endpoint);
+    subscriber.set(zmq::sockopt::subscribe, "");
+
+    zmq::message_t greeting;
+    while (!subscriber.recv(greeting, zmq::recv_flags::none))
+    {
+    }
+    joined.fetch_add(1, std::memory_order_acq_rel);
+}
+
+/// @brief Send greetings until `expected` subscribers have joined
+inline void greet_subscribers(zmq::socket_t &publisher, const std::atomic<std::size_t> &joined, std::size_t expected)
+{
+    while (joined.load(std::memory_order_acquire) < expected)
+    {
+        publisher.send(zmq::message_t{}, zmq::send_flags::dontwait);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+/// @brief Send end-of-stream messages until `expected` readers have stopped. A conflating subscriber
+/// keeps only the newest message, so an end-of-stream message could replace a last block it has not
+/// received yet. Given the `last_bytes` bytes at `last`, copies of the last block are sent instead,
+/// for readers that stop once they have it
+inline void end_stream(zmq::socket_t &publisher,
+                       const std::atomic<std::size_t> &finished,
+                       std::size_t expected,
+                       const void *last = nullptr,
+                       std::size_t last_bytes = 0)
+{
+    while (finished.load(std::memory_order_acquire) < expected)
+    {
+        if (last != nullptr)
+        {
+            publisher.send(zmq::message_t(last, last_bytes), zmq::send_flags::dontwait);
+        }
+        else
+        {
+            publisher.send(zmq::message_t(std::size_t{1}), zmq::send_flags::dontwait);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+/// @brief Receive the next block into `dst`. Returns false at the end of the stream, greetings still queued are skipped
+template <typename data_type>
+bool receive_block(zmq::socket_t &subscriber, zmq::message_t &message, data_type *dst, std::size_t block_size)
+{
+    const std::size_t bytes = block_size * sizeof(data_type);
+    while (true)
+    {
+        if (!subscriber.recv(message, zmq::recv_flags::none))
+        {
+            return false;
+        }
+        if (message.size() == bytes)
+        {
+            std::memcpy(dst, message.data(), bytes);
+            return true;
+        }
+        if (message.size() != 0)
+        {
+            return false;
+        }
+    }
+}
+
+inline void add_zmq_labels(benchmark_results &results, const zmq_options &options)
+{
+    results.labels.emplace_back("zmq_transport", to_string(options.transport));
+    results.labels.emplace_back("zmq_high_water_mark", std::to_string(options.high_water_mark));
+    results.labels.emplace_back("zmq_conflate", options.conflate ? "true" : "false");
+}
+
+template <typename data_type, std::size_t alignment_bytes>
+void zmq_writer(zmq::socket_t &publisher,
+                zmq_block_pool<data_type, alignment_bytes> &pool,
                 std::size_t cycles,
+                std::size_t sample_every,
+                const std::atomic<std::size_t> &joined,
+                const std::atomic<std::size_t> &finished,
+                std::size_t num_readers,
+                bool conflate,
                 std::barrier<> &thread_barrier,
-                double &write_time_ns)
+                double &write_time_ns,
+                latency_histogram &histogram)
 {
     spdlog::info("ZMQ writer starts");
 
-    zmq::socket_t publisher(ctx, zmq::socket_type::pub);
-    publisher.bind("inproc://endpoint");
-
-    data_type value{0};
-    aligned_array<data_type, alignment_bytes> src(block_size);
-    zmq::mutable_buffer buffer(src.data(), src.size() * sizeof(data_type));
-    zmq::send_result_t result;
+    const std::size_t block_size = pool.block_size();
+    benchmark_timer timer(sample_every);
+    greet_subscribers(publisher, joined, num_readers);
 
     thread_barrier.arrive_and_wait();
 
     write_time_ns = 0;
-    for (size_t k = 1; k < cycles; ++k)
+    std::size_t timed{0};
+    const data_type *last = nullptr; // never acquired again, so it keeps the last block once ZeroMQ releases it
+    for (size_t k = 0; k + 1 < cycles; ++k)
     {
-        fill_array(src, value++);
-        const auto t0 = std::chrono::high_resolution_clock::now();
-        result = publisher.send(buffer);
-        const auto dt = std::chrono::high_resolution_clock::now() - t0;
-        write_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count();
+        const std::size_t index = k % pool.size();
+        data_type *block = pool.acquire(index);
+        last = block;
+        std::fill(block, block + block_size, static_cast<data_type>(k));
+        zmq::message_t message = pool.message(index);
+        if (timer.sample())
+        {
+            const std::uint64_t t0 = timer.start();
+            publisher.send(message, zmq::send_flags::none);
+            const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+            write_time_ns += static_cast<double>(ns);
+            histogram.record(ns);
+            ++timed;
+        }
+        else
+        {
+            publisher.send(message, zmq::send_flags::none);
+        }
     }
 
-    write_time_ns = write_time_ns / cycles;
+    write_time_ns = timed > 0 ? write_time_ns / timed : 0.0;
     spdlog::info("ZMQ writer terminates. Write time, ns: {:.1f}", write_time_ns);
 
-    thread_barrier.arrive_and_wait();
+    if (conflate && last != nullptr)
+    {
+        end_stream(publisher, finished, num_readers, last, block_size * sizeof(data_type));
+    }
+    else
+    {
+        end_stream(publisher, finished, num_readers);
+    }
 }
 
 template <typename data_type, std::size_t alignment_bytes>
-void zmq_reader(zmq::context_t &ctx,
+void zmq_reader(const std::string &endpoint,
+                zmq::context_t &ctx,
+                const zmq_options &options,
                 std::size_t block_size,
                 std::size_t cycles,
                 std::size_t index,
+                std::size_t sample_every,
+                std::atomic<std::size_t> &joined,
+                std::atomic<std::size_t> &finished,
                 std::barrier<> &thread_barrier,
-                double &read_time_ns)
+                double &read_time_ns,
+                std::size_t &lost,
+                std::size_t &received,
+                latency_histogram &histogram)
 {
     spdlog::info("Reader {} starts", index);
 
     zmq::socket_t subscriber(ctx, zmq::socket_type::sub);
-    subscriber.connect("inproc://endpoint");
-    subscriber.set(zmq::sockopt::subscribe, "");
+    join_publisher(subscriber, endpoint, options, joined);
 
     aligned_array<data_type, alignment_bytes> dst(block_size);
-    zmq::mutable_buffer buffer(dst.data(), dst.size() * sizeof(data_type));
-    zmq::recv_buffer_result_t result{};
+    zmq::message_t message;
+    benchmark_timer timer(sample_every);
 
     thread_barrier.arrive_and_wait();
 
     read_time_ns = 0;
-    for (size_t k = 0; k < cycles - 1; ++k)
+    std::size_t timed{0};
+    std::size_t expected{0};
+    lost = 0;
+    bool more = true;
+    while (more && expected + 1 < cycles)
     {
-        const auto t0 = std::chrono::high_resolution_clock::now();
-        result = subscriber.recv(buffer, zmq::recv_flags::none);
-        const auto dt = std::chrono::high_resolution_clock::now() - t0;
-        read_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count();
+        if (timer.sample())
+        {
+            const std::uint64_t t0 = timer.start();
+            more = receive_block(subscriber, message, dst.data(), block_size);
+            const std::uint64_t ns = timer.elapsed_ns(t0, timer.stop());
+            if (more)
+            {
+                read_time_ns += static_cast<double>(ns);
+                histogram.record(ns);
+                ++timed;
+            }
+        }
+        else
+        {
+            more = receive_block(subscriber, message, dst.data(), block_size);
+        }
+        if (more)
+        {
+            const auto seq = static_cast<std::size_t>(dst.data()[0]);
+            lost += seq > expected ? seq - expected : 0; // dropped at the high water mark or conflated
+            expected = seq + 1;
+        }
     }
+    lost += cycles - 1 - expected;
+    received = expected;
 
-    read_time_ns = read_time_ns / (cycles - 1);
-
-    thread_barrier.arrive_and_wait();
-    spdlog::info("Reader {} terminates. Read time, ns: {:.1f}", index, read_time_ns);
+    read_time_ns = timed > 0 ? read_time_ns / timed : 0.0;
+    finished.fetch_add(1, std::memory_order_acq_rel);
+    spdlog::info("Reader {} terminates. Read time, ns: {:.1f}, lost: {}", index, read_time_ns, lost);
 }
 
 template <typename data_type, std::size_t alignment_bytes>
-std::vector<double> run_zmq_benchmark(std::size_t block_size,
-                                      std::size_t num_readers,
-                                      std::size_t cycles)
+benchmark_results run_zmq_benchmark(std::size_t num_blocks,
+                                    std::size_t block_size,
+                                    std::size_t num_readers,
+                                    std::size_t cycles,
+                                    std::size_t sample_every = 1,
+                                    placement policy = placement::none,
+                                    const zmq_options &options = {})
 {
-    std::barrier<> thread_barrier(num_readers + 1);
-    std::vector<double> times(num_readers + 1, 0.0);
+    std::barrier<> thread_barrier(num_readers + 2); // this thread takes part in the first phase only, once the threads are placed
+    benchmark_results results{std::vector<double>(num_readers + 1, 0.0), std::vector<std::size_t>(num_readers)};
+    results.labels.emplace_back("clock_source", to_string(clock_ticks::calibration().source));
+    add_zmq_labels(results, options);
+    std::vector<double> &times = results.times;
+    std::atomic<std::size_t> joined{0};
+    std::atomic<std::size_t> finished{0};
 
-    zmq::context_t ctx(0);
+    // destroyed in reverse: the publisher closes, the context waits for every queued message to be freed, then the pool goes
+    zmq_block_pool<data_type, alignment_bytes> pool(std::max(num_blocks, zmq_block_pool<data_type, alignment_bytes>::min_blocks), block_size);
+    zmq::context_t ctx(1);
+    zmq::socket_t publisher(ctx, zmq::socket_type::pub);
+    const std::string endpoint = bind_publisher(publisher, options);
 
     std::thread writer_thread(zmq_writer<data_type, alignment_bytes>,
-                              std::ref(ctx),
-                              block_size,
+                              std::ref(publisher),
+                              std::ref(pool),
                               cycles,
+                              sample_every,
+                              std::cref(joined),
+                              std::cref(finished),
+                              num_readers,
+                              options.conflate,
                               std::ref(thread_barrier),
-                              std::ref(times[0]));
+                              std::ref(times[0]),
+                              std::ref(results.write_latency));
 
+    std::vector<latency_histogram> histograms(num_readers);
+    std::vector<std::size_t> received(num_readers);
     std::vector<std::thread> readers;
     for (std::size_t k = 0; k < num_readers; ++k)
     {
         readers.emplace_back(zmq_reader<data_type, alignment_bytes>,
+                             std::cref(endpoint),
                              std::ref(ctx),
+                             std::cref(options),
                              block_size,
                              cycles,
                              k,
+                             sample_every,
+                             std::ref(joined),
+                             std::ref(finished),
+                             std::ref(thread_barrier),
+                             std::ref(times[k + 1]),
+                             std::ref(results.lost[k]),
+                             std::ref(received[k]),
+                             std::ref(histograms[k]));
+    }
+
+    place_threads(policy, std::span<std::thread>(&writer_thread, 1), readers, results);
+    thread_barrier.arrive_and_drop();
+
+    writer_thread.join();
+    for (auto &r : readers)
+    {
+        r.join();
+    }
+    for (const auto &h : histograms)
+    {
+        results.read_latency.merge(h);
+    }
+    // sequence of the newest block each subscriber got, -1 if it got none
+    for (std::size_t k = 0; k < num_readers; ++k)
+    {
+        results.metrics.emplace_back(fmt::format("reader_{}_last_block", k), static_cast<double>(received[k]) - 1.0);
+    }
+
+    return results;
+}
+
+/// @brief Publish for `duration` as fast as the pool and ZeroMQ accept messages, then end the stream
+template <typename data_type, std::size_t alignment_bytes>
+void zmq_throughput_writer(zmq::socket_t &publisher,
+                           zmq_block_pool<data_type, alignment_bytes> &pool,
+                           std::chrono::nanoseconds duration,
+                           progress_counter &written,
+                           const std::atomic<std::size_t> &joined,
+                           const std::atomic<std::size_t> &finished,
+                           std::size_t num_readers,
+                           std::barrier<> &thread_barrier,
+                           double &elapsed_ns)
+{
+    spdlog::info("ZMQ throughput writer starts");
+
+    greet_subscribers(publisher, joined, num_readers);
+
+    thread_barrier.arrive_and_wait();
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto deadline = t0 + duration;
+    std::size_t n{0};
+    while ((n % 64 != 0) || std::chrono::steady_clock::now() < deadline)
+    {
+        const std::size_t index = n % pool.size();
+        pool.acquire(index)[0] = static_cast<data_type>(n);
+        publisher.send(pool.message(index), zmq::send_flags::none);
+        written.value.store(++n, std::memory_order_release);
+    }
+    elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count());
+
+    end_stream(publisher, finished, num_readers);
+    spdlog::info("ZMQ throughput writer terminates. Messages sent: {}", n);
+}
+
+template <typename data_type, std::size_t alignment_bytes>
+void zmq_throughput_reader(const std::string &endpoint,
+                           zmq::context_t &ctx,
+                           const zmq_options &options,
+                           std::size_t block_size,
+                           std::size_t index,
+                           const progress_counter &written,
+                           std::atomic<std::size_t> &joined,
+                           std::atomic<std::size_t> &finished,
+                           std::barrier<> &thread_barrier,
+                           double &elapsed_ns,
+                           std::size_t &received,
+                           std::size_t &lost,
+                           double &mean_lag)
+{
+    spdlog::info("ZMQ throughput reader {} starts", index);
+
+    zmq::socket_t subscriber(ctx, zmq::socket_type::sub);
+    join_publisher(subscriber, endpoint, options, joined);
+
+    aligned_array<data_type, alignment_bytes> dst(block_size);
+    zmq::message_t message;
+
+    thread_barrier.arrive_and_wait();
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::size_t expected{0};
+    double lag{0};
+    received = 0;
+    lost = 0;
+    while (receive_block(subscriber, message, dst.data(), block_size))
+    {
+        const auto seq = static_cast<std::size_t>(dst.data()[0]);
+        lost += seq > expected ? seq - expected : 0; // dropped at the high water mark or conflated
+        expected = seq + 1;
+        ++received;
+        const std::size_t head = written.value.load(std::memory_order_acquire);
+        lag += head > expected ? static_cast<double>(head - expected) : 0.0;
+    }
+    elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count());
+    lost += written.value.load(std::memory_order_acquire) - expected;
+    mean_lag = received > 0 ? lag / static_cast<double>(received) : 0.0;
+    finished.fetch_add(1, std::memory_order_acq_rel);
+    spdlog::info("ZMQ throughput reader {} terminates. Received: {}, lost: {}, mean lag: {:.1f}", index, received, lost, mean_lag);
+}
+
+/// @brief Time-boxed throughput over ZeroMQ, reported like run_throughput_benchmark. Publishers drop
+/// messages for subscribers that fall behind the high water mark, those show up in `lost`
+template <typename data_type, std::size_t alignment_bytes>
+benchmark_results run_zmq_throughput_benchmark(std::size_t num_blocks,
+                                               std::size_t block_size,
+                                               std::size_t num_readers,
+                                               std::chrono::nanoseconds duration,
+                                               const zmq_options &options = {})
+{
+    std::barrier<> thread_barrier(num_readers + 1);
+    benchmark_results results{std::vector<double>(num_readers + 1), std::vector<std::size_t>(num_readers), std::vector<double>(num_readers)};
+    add_zmq_labels(results, options);
+    std::vector<double> elapsed(num_readers + 1);
+    std::vector<std::size_t> received(num_readers);
+    progress_counter written;
+    std::atomic<std::size_t> joined{0};
+    std::atomic<std::size_t> finished{0};
+
+    zmq_block_pool<data_type, alignment_bytes> pool(std::max(num_blocks, zmq_block_pool<data_type, alignment_bytes>::min_blocks), block_size); // outlives the context, see run_zmq_benchmark
+    zmq::context_t ctx(1);
+    zmq::socket_t publisher(ctx, zmq::socket_type::pub);
+    const std::string endpoint = bind_publisher(publisher, options);
+
+    std::thread writer_thread(zmq_throughput_writer<data_type, alignment_bytes>,
+                              std::ref(publisher),
+                              std::ref(pool),
+                              duration,
+                              std::ref(written),
+                              std::cref(joined),
+                              std::cref(finished),
+                              num_readers,
+                              std::ref(thread_barrier),
+                              std::ref(elapsed[0]));
+
+    std::vector<std::thread> readers;
+    for (std::size_t k = 0; k < num_readers; ++k)
+    {
+        readers.emplace_back(zmq_throughput_reader<data_type, alignment_bytes>,
+                             std::cref(endpoint),
+                             std::ref(ctx),
+                             std::cref(options),
+                             block_size,
+                             k,
+                             std::cref(written),
+                             std::ref(joined),
+                             std::ref(finished),
                              std::ref(thread_barrier),
-                             std::ref(times[k + 1]));
+                             std::ref(elapsed[k + 1]),
+                             std::ref(received[k]),
+                             std::ref(results.lost[k]),
+                             std::ref(results.lag[k]));
     }
 
     writer_thread.join();
@@ -117,5 +569,16 @@ std::vector<double> run_zmq_benchmark(std::size_t block_size,
         r.join();
     }
 
-    return times;
-}
\ No newline at end of file
+    const std::size_t messages = written.value.load();
+    std::size_t delivered{0};
+    for (const auto r : received)
+    {
+        delivered += r;
+    }
+    for (std::size_t k = 0; k <= num_readers; ++k)
+    {
+        results.times[k] = messages > 0 ? elapsed[k] / static_cast<double>(messages) : 0.0;
+    }
+    add_throughput_metrics(results, messages, delivered, block_size * sizeof(data_type), elapsed[0]);
+    return results;
+}
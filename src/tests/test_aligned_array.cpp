@@ -23,4 +23,58 @@ TEST_CASE("aligned_array.offset checks bounds")
     REQUIRE_NOTHROW(p = a.offset(0));
     REQUIRE_NOTHROW(p = a.offset(n - 1));
     REQUIRE_THROWS_AS(p = a.offset(n), std::out_of_range);
-}
\ No newline at end of file
+}
+
+TEST_CASE("aligned_array can be copied and moved")
+{
+    constexpr std::size_t n = 10;
+    aligned_array<int> a(n);
+    fill_array(a, 7);
+    aligned_array<int> b;
+    b = a;
+    REQUIRE(b.size() == n);
+    REQUIRE(b.data()[n - 1] == 7);
+    aligned_array<int> c;
+    c = std::move(b);
+    REQUIRE(c.size() == n);
+    REQUIRE(c.data()[0] == 7);
+}
+
+TEST_CASE("aligned_array supports page backends")
+{
+    constexpr std::size_t n = 10 * 16384;
+    constexpr std::size_t alignment_bytes = 64;
+    for (const page_options pages : {page_options{page_backend::heap, true},
+                                     page_options{page_backend::mmap, false},
+                                     page_options{page_backend::mmap, true},
+                                     page_options{page_backend::huge_pages, false},
+                                     page_options{page_backend::transparent_huge_pages, true}})
+    {
+        aligned_array<std::uint64_t, alignment_bytes> a(n, pages);
+        REQUIRE(a.size() == n);
+        REQUIRE(reinterpret_cast<uintptr_t>(a.data()) % alignment_bytes == 0);
+        fill_array(a, std::uint64_t{42});
+        REQUIRE(a.data()[n - 1] == 42);
+        if (pages.backend == page_backend::huge_pages)
+        {
+            REQUIRE((a.backend() == page_backend::huge_pages || a.backend() == page_backend::transparent_huge_pages));
+        }
+
+        const aligned_array<std::uint64_t, alignment_bytes> copy(a);
+        REQUIRE(copy.data()[0] == 42);
+    }
+}
+
+TEST_CASE("aligned_array holds trivially copyable structs larger than the alignment")
+{
+    struct frame
+    {
+        float samples[8];
+    };
+    constexpr std::size_t n = 5;
+    aligned_array<frame, 16> a(n);
+    REQUIRE(reinterpret_cast<uintptr_t>(a.data()) % 16 == 0);
+    fill_array(a, frame{{1, 2, 3, 4, 5, 6, 7, 8}});
+    const aligned_array<frame, 16> copy(a);
+    REQUIRE(copy.data()[n - 1].samples[7] == 8);
+}
@@ -0,0 +1,71 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <aligned_array.hpp>
+#include <atomic_copy.hpp>
+#include <seqlock_solution.hpp>
+
+TEMPLATE_TEST_CASE("copy policies copy whole blocks", "", memcpy_copy, atomic_copy, simd_atomic_copy<>, simd_atomic_copy<64>,
+                   streaming_copy<>, (streaming_copy<64, true>))
+{
+    constexpr std::size_t alignment = 64;
+    for (const std::size_t count : {1, 3, 16, 100, 1024, 16384})
+    {
+        aligned_array<std::uint64_t, alignment> src(count);
+        aligned_array<std::uint64_t, alignment> ring(count);
+        aligned_array<std::uint64_t, alignment> dst(count);
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            src.data()[k] = 3 * k + 1;
+        }
+        fill_array(dst, std::uint64_t{0});
+
+        TestType::store(ring.data(), src.data(), count);
+        TestType::load(dst.data(), ring.data(), count);
+        REQUIRE(std::memcmp(src.data(), dst.data(), count * sizeof(std::uint64_t)) == 0);
+    }
+}
+
+TEST_CASE("streaming copies prefetch the block they are given")
+{
+    aligned_array<std::uint64_t, 64> ring(32);
+    aligned_array<std::uint64_t, 64> dst(16);
+    for (std::size_t k = 0; k < ring.size(); ++k)
+    {
+        ring.data()[k] = k;
+    }
+    // the last block of the ring prefetches the first one instead of running past the end
+    streaming_copy<64, true>::load(dst.data(), ring.data() + 16, 16, ring.data());
+    REQUIRE(dst.data()[0] == 16);
+    REQUIRE(dst.data()[15] == 31);
+}
+
+TEMPLATE_TEST_CASE("seqlock copy policies write and read data", "",
+                   (atomic_seqlock_solution<std::uint64_t, 16>),
+                   (simd_seqlock_solution<std::uint64_t, 16>),
+                   (streaming_seqlock_solution<std::uint64_t, 16>),
+                   (prefetch_seqlock_solution<std::uint64_t, 16>))
+{
+    constexpr std::size_t num_blocks = 10;
+    constexpr std::size_t block_size = 640;
+    TestType a(num_blocks, block_size);
+    aligned_array<std::uint64_t> src(block_size);
+    aligned_array<std::uint64_t> dst(block_size);
+    for (std::uint64_t k = 0; k < 2 * num_blocks; ++k)
+    {
+        fill_array(src, k);
+        a.write(src.data(), block_size);
+        a.read(dst.data(), block_size, (k % num_blocks) * block_size);
+        REQUIRE(std::memcmp(src.data(), dst.data(), block_size * sizeof(std::uint64_t)) == 0);
+    }
+}
+TEST_CASE("streaming copies only stream large aligned blocks")
+{
+    alignas(64) static std::uint64_t ring[8192];
+    using policy = streaming_copy<4096>;
+#if defined(PC_HAS_SIMD_COPY) && !defined(PC_THREAD_SANITIZER)
+    REQUIRE(policy::stream(ring, 4096));
+#endif
+    REQUIRE_FALSE(policy::stream(ring, 4080));
+    REQUIRE_FALSE(policy::stream(ring, 4104));
+    REQUIRE_FALSE(policy::stream(reinterpret_cast<char *>(ring) + 8, 8192));
+}
@@ -0,0 +1,85 @@
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <channel_benchmark.hpp>
+#include <channel_seqlock_solution.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    /// @brief Block whose sample of channel c in frame f is make_payload(100 * c + f + base)
+    template <typename data_type>
+    auto interleaved_block(std::size_t frames, std::size_t channels, std::size_t base) -> std::vector<data_type>
+    {
+        std::vector<data_type> block(frames * channels);
+        for (std::size_t f = 0; f < frames; ++f)
+        {
+            for (std::size_t c = 0; c < channels; ++c)
+            {
+                block[f * channels + c] = make_payload<data_type>(100 * c + f + base);
+            }
+        }
+        return block;
+    }
+}
+
+TEMPLATE_TEST_CASE("channel SeqLock keeps the channels of every frame apart", "",
+                   (channel_seqlock_solution<float, 16, channel_layout::interleaved>),
+                   (channel_seqlock_solution<float, 16, channel_layout::planar>),
+                   (channel_seqlock_solution<std::int16_t, 16, channel_layout::interleaved>),
+                   (channel_seqlock_solution<std::int16_t, 16, channel_layout::planar>),
+                   (channel_seqlock_solution<sensor_sample, 16, channel_layout::interleaved>),
+                   (channel_seqlock_solution<sensor_sample, 16, channel_layout::planar>))
+{
+    using data_type = typename TestType::value_type;
+    constexpr std::size_t num_blocks = 3;
+    constexpr std::size_t frames = 13; // planes are padded to whole cache lines
+    constexpr std::size_t channels = 3;
+    TestType store(num_blocks, frames, channels);
+    REQUIRE(store.block_size() == frames * channels);
+    REQUIRE(store.size() == num_blocks * frames * channels);
+    store.fill(make_payload<data_type>(0));
+
+    for (std::size_t k = 0; k < num_blocks; ++k)
+    {
+        const auto block = interleaved_block<data_type>(frames, channels, 1000 * k);
+        store.write(block.data(), block.size());
+    }
+
+    std::vector<data_type> whole(frames * channels);
+    std::vector<data_type> channel(frames);
+    for (std::size_t k = 0; k < num_blocks; ++k)
+    {
+        const auto expected = interleaved_block<data_type>(frames, channels, 1000 * k);
+        store.read(whole.data(), whole.size(), k * store.block_size());
+        REQUIRE(whole == expected);
+        for (std::size_t c = 0; c < channels; ++c)
+        {
+            store.read_channel(channel.data(), frames, k * store.block_size(), c);
+            for (std::size_t f = 0; f < frames; ++f)
+            {
+                REQUIRE(channel[f] == make_payload<data_type>(100 * c + f + 1000 * k));
+            }
+        }
+    }
+
+    REQUIRE_THROWS_AS(store.read_channel(channel.data(), frames, 0, channels), std::runtime_error);
+    REQUIRE_THROWS_AS(store.read_channel(channel.data(), frames, 1, 0), std::runtime_error);
+    REQUIRE_THROWS_AS(store.write(whole.data(), frames), std::runtime_error);
+}
+
+TEST_CASE("channel benchmark times every write and every read in both layouts")
+{
+    constexpr std::size_t cycles = 500;
+    constexpr std::size_t readers = 3;
+    const auto check = [&](const benchmark_results &results)
+    {
+        REQUIRE(results.times.size() == readers + 1);
+        REQUIRE(results.write_latency.count() == cycles);
+        REQUIRE(results.read_latency.count() == readers * cycles);
+    };
+    check(run_channel_benchmark<channel_seqlock_solution<float, 16, channel_layout::interleaved>, float, 16>(8, 64, 2, readers, cycles));
+    check(run_channel_benchmark<channel_seqlock_solution<sensor_sample, 16, channel_layout::planar>, sensor_sample, 16>(8, 64, 2, readers, cycles));
+}
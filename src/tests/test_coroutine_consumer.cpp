@@ -0,0 +1,116 @@
+#include <catch2/catch_test_macros.hpp>
+#include <coroutine_consumer.hpp>
+#include <seqlock_solution.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using ring = seqlock_solution<std::uint64_t, 16>;
+
+    consumer_task collect(block_scheduler<ring, std::uint64_t> &scheduler,
+                          consumer_cursor &consumer,
+                          std::size_t cycles,
+                          std::vector<std::uint64_t> &seen)
+    {
+        std::uint64_t block[4];
+        while (consumer.next < cycles)
+        {
+            const read_result result = co_await scheduler.next_block(block, consumer);
+            REQUIRE(result.status == read_status::ok);
+            seen.push_back(block[0]);
+        }
+    }
+
+    consumer_task failing(block_scheduler<ring, std::uint64_t> &scheduler, consumer_cursor &consumer)
+    {
+        std::uint64_t block[4];
+        co_await scheduler.next_block(block, consumer);
+        throw std::runtime_error("consumer failed");
+    }
+}
+
+TEST_CASE("coroutine consumers read published blocks without suspending")
+{
+    ring store(4, 4);
+    const std::uint64_t src[4] = {7, 7, 7, 7};
+    store.write(src, 4);
+    store.write(src, 4);
+
+    block_scheduler<ring, std::uint64_t> scheduler(store, 4);
+    std::vector<consumer_cursor> cursors(3);
+    std::vector<std::vector<std::uint64_t>> seen(3);
+    for (std::size_t k = 0; k < cursors.size(); ++k)
+    {
+        scheduler.spawn(collect(scheduler, cursors[k], 2, seen[k]));
+    }
+    REQUIRE(scheduler.size() == 3);
+    scheduler.run();
+    for (std::size_t k = 0; k < cursors.size(); ++k)
+    {
+        REQUIRE(seen[k] == std::vector<std::uint64_t>{7, 7});
+        REQUIRE(cursors[k].lost == 0);
+    }
+}
+
+TEST_CASE("the scheduler resumes parked consumers when the writer publishes")
+{
+    constexpr std::size_t cycles = 200;
+    ring store(8, 4);
+    block_scheduler<ring, std::uint64_t> scheduler(store, 4);
+    std::vector<consumer_cursor> cursors(4);
+    std::vector<std::vector<std::uint64_t>> seen(4);
+    for (std::size_t k = 0; k < cursors.size(); ++k)
+    {
+        scheduler.spawn(collect(scheduler, cursors[k], cycles, seen[k]));
+    }
+
+    std::thread writer_thread([&store]
+                              {
+        for (std::uint64_t k = 0; k < cycles; ++k)
+        {
+            const std::uint64_t src[4] = {k, k, k, k};
+            store.write(src, 4);
+        } });
+    scheduler.run();
+    writer_thread.join();
+
+    for (std::size_t k = 0; k < cursors.size(); ++k)
+    {
+        REQUIRE(seen[k].size() + cursors[k].lost == cycles);
+        REQUIRE(std::is_sorted(seen[k].begin(), seen[k].end()));
+    }
+}
+
+TEST_CASE("the scheduler rethrows what a consumer threw")
+{
+    ring store(4, 4);
+    const std::uint64_t src[4] = {1, 1, 1, 1};
+    store.write(src, 4);
+
+    block_scheduler<ring, std::uint64_t> scheduler(store, 4);
+    consumer_cursor consumer;
+    scheduler.spawn(failing(scheduler, consumer));
+    REQUIRE_THROWS_AS(scheduler.run(), std::runtime_error);
+}
+
+TEST_CASE("coroutine benchmark accounts for every block of every consumer")
+{
+    constexpr std::size_t cycles = 1000;
+    for (const std::size_t threads : {std::size_t{1}, std::size_t{2}})
+    {
+        const benchmark_results results = run_coroutine_benchmark<ring, std::uint64_t, 16>(10, 16, 5, cycles, threads);
+        REQUIRE(results.times.size() == 6);
+        REQUIRE(results.lost.size() == 5);
+        REQUIRE(results.write_latency.count() == cycles - 1); // the first block is written before the clock starts
+        std::size_t lost{0};
+        for (const auto l : results.lost)
+        {
+            lost += l;
+        }
+        REQUIRE(results.read_latency.count() + lost == 5 * cycles);
+    }
+}
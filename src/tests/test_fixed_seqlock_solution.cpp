@@ -0,0 +1,62 @@
+#include <catch2/catch_test_macros.hpp>
+#include <fixed_seqlock_solution.hpp>
+#include <benchmark.hpp>
+
+TEST_CASE("fixed_seqlock_solution is correctly implemented")
+{
+    constexpr std::size_t num_blocks = 8;
+    constexpr std::size_t block_size = 64;
+    constexpr std::size_t alignment = 16;
+    using solution = fixed_seqlock_solution<std::uint64_t, alignment, num_blocks, block_size>;
+    solution a(num_blocks, block_size);
+    aligned_array<std::uint64_t> src(block_size);
+    aligned_array<std::uint64_t> dst(block_size);
+    a.fill(0);
+
+    SECTION("the constructor rejects another geometry")
+    {
+        REQUIRE_THROWS_AS(solution(num_blocks + 1, block_size), std::runtime_error);
+        REQUIRE_THROWS_AS(solution(num_blocks, block_size / 2), std::runtime_error);
+        REQUIRE(solution::size() == num_blocks * block_size);
+    }
+
+    SECTION("writes wrap around the ring and reads find every block")
+    {
+        for (std::uint64_t k = 0; k < 3 * num_blocks; ++k)
+        {
+            fill_array(src, k);
+            a.write(src.data(), block_size);
+            const std::size_t offset = (k % num_blocks) * block_size;
+            a.read(dst.data(), block_size, offset);
+            REQUIRE(std::memcmp(src.data(), dst.data(), block_size * sizeof(std::uint64_t)) == 0);
+        }
+        REQUIRE(a.head() == 3 * num_blocks);
+    }
+
+    SECTION("read_next reports blocks lost to the writer")
+    {
+        consumer_cursor consumer;
+        REQUIRE(a.read_next(dst.data(), block_size, consumer).status == read_status::not_ready);
+        for (std::uint64_t k = 0; k < num_blocks + 3; ++k)
+        {
+            fill_array(src, k);
+            a.write(src.data(), block_size);
+        }
+        const read_result result = a.read_next(dst.data(), block_size, consumer);
+        REQUIRE(result.status == read_status::ok);
+        REQUIRE(result.lost == 3);
+        REQUIRE(dst.data()[0] == 3);
+        REQUIRE(consumer.next == 4);
+    }
+}
+
+TEST_CASE("fixed_seqlock_solution runs in the benchmarks")
+{
+    using solution = fixed_seqlock_solution<std::uint64_t, 16, 16, 16>;
+    const benchmark_results results = run_benchmark<solution, std::uint64_t, 16>(16, 16, 2, 2000);
+    REQUIRE(results.times.size() == 3);
+    REQUIRE(results.read_latency.count() == 2 * 2000);
+
+    const benchmark_results throughput = run_throughput_benchmark<solution, std::uint64_t, 16>(16, 16, 2, std::chrono::milliseconds(50));
+    REQUIRE(throughput.lost == std::vector<std::size_t>{0, 0});
+}
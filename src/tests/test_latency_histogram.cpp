@@ -0,0 +1,73 @@
+#include <catch2/catch_test_macros.hpp>
+#include <latency_histogram.hpp>
+#include <benchmark.hpp>
+#include <seqlock_solution.hpp>
+
+TEST_CASE("latency_histogram is correctly implemented")
+{
+    latency_histogram h;
+
+    SECTION("an empty histogram reports zeros")
+    {
+        REQUIRE(h.count() == 0);
+        REQUIRE(h.min() == 0);
+        REQUIRE(h.max() == 0);
+        REQUIRE(h.value_at_percentile(99.0) == 0);
+    }
+
+    SECTION("every value falls into a bucket whose upper edge is within the precision")
+    {
+        for (const std::uint64_t v : std::initializer_list<std::uint64_t>{0, 1, 63, 64, 65, 127, 128, 1000, 123456789, latency_histogram::max_trackable})
+        {
+            const std::size_t index = latency_histogram::index_of(v);
+            REQUIRE(index < latency_histogram::bucket_count);
+            const std::uint64_t edge = latency_histogram::upper_edge(index);
+            REQUIRE(edge >= v);
+            REQUIRE(edge - v <= v / latency_histogram::sub_buckets);
+            REQUIRE(latency_histogram::index_of(edge) == index);
+            REQUIRE((v == latency_histogram::max_trackable || latency_histogram::index_of(edge + 1) == index + 1));
+        }
+    }
+
+    SECTION("percentiles of a uniform distribution")
+    {
+        for (std::uint64_t v = 1; v <= 10000; ++v)
+        {
+            h.record(v);
+        }
+        REQUIRE(h.count() == 10000);
+        REQUIRE(h.min() == 1);
+        REQUIRE(h.max() == 10000);
+        REQUIRE(h.mean() == 5000.5);
+        const auto within = [](std::uint64_t value, std::uint64_t expected)
+        {
+            return value >= expected && value - expected <= expected / latency_histogram::sub_buckets;
+        };
+        REQUIRE(within(h.value_at_percentile(50.0), 5000));
+        REQUIRE(within(h.value_at_percentile(90.0), 9000));
+        REQUIRE(within(h.value_at_percentile(99.0), 9900));
+        REQUIRE(h.value_at_percentile(100.0) == 10000);
+    }
+
+    SECTION("merging adds counts and keeps the extremes")
+    {
+        latency_histogram other;
+        h.record(std::uint64_t{10});
+        other.record(std::uint64_t{5});
+        other.record(std::uint64_t{1000000});
+        h.merge(other);
+        REQUIRE(h.count() == 3);
+        REQUIRE(h.min() == 5);
+        REQUIRE(h.max() == 1000000);
+        REQUIRE(h.value_at_percentile(50.0) == 10);
+    }
+}
+
+TEST_CASE("benchmarks record every operation in the latency histograms")
+{
+    using solution = seqlock_solution<std::uint64_t, 16>;
+    const benchmark_results results = run_benchmark<solution, std::uint64_t, 16>(4, 16, 2, 1000);
+    REQUIRE(results.write_latency.count() == 999);
+    REQUIRE(results.read_latency.count() == 2000);
+    REQUIRE(results.read_latency.value_at_percentile(50.0) <= results.read_latency.max());
+}
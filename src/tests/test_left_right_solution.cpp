@@ -0,0 +1,94 @@
+#include <catch2/catch_test_macros.hpp>
+#include <left_right_solution.hpp>
+#include <benchmark.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("left_right_solution is correctly implemented")
+{
+    constexpr std::size_t num_blocks = 10;
+    constexpr std::size_t block_size = 640;
+    constexpr std::size_t alignment = 16;
+    left_right_solution<std::uint64_t, alignment> a(num_blocks, block_size);
+    aligned_array<std::uint64_t> src(block_size);
+    aligned_array<std::uint64_t> dst(block_size);
+
+    SECTION("calls catch wrong input")
+    {
+        REQUIRE_THROWS_AS(a.write(nullptr, block_size), std::runtime_error);
+        REQUIRE_THROWS_AS(a.write(src.data(), 2), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read(nullptr, block_size, 0), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read(dst.data(), 2, 0), std::runtime_error);
+    }
+
+    SECTION("both copies hold every block that was written")
+    {
+        // every write switches the readers to the other copy, so consecutive checks see both copies
+        for (std::uint64_t k = 0; k < 3 * num_blocks; ++k)
+        {
+            fill_array(src, k);
+            a.write(src.data(), block_size);
+            for (std::uint64_t j = k + 1 > num_blocks ? k + 1 - num_blocks : 0; j <= k; ++j)
+            {
+                a.read(dst.data(), block_size, (j % num_blocks) * block_size);
+                REQUIRE(dst.data()[0] == j);
+                REQUIRE(dst.data()[block_size - 1] == j);
+            }
+        }
+    }
+}
+
+TEST_CASE("left_right_solution readers never see a torn block")
+{
+    constexpr std::size_t num_blocks = 4;
+    constexpr std::size_t block_size = 256;
+    constexpr std::size_t readers = 3;
+    left_right_solution<std::uint64_t, 16, 2> a(num_blocks, block_size); // fewer stripes than readers
+    a.fill(0);
+    std::atomic<bool> done{false};
+    std::atomic<bool> torn{false};
+
+    std::vector<std::thread> threads;
+    for (std::size_t r = 0; r < readers; ++r)
+    {
+        threads.emplace_back([&]
+                             {
+                                 aligned_array<std::uint64_t> dst(block_size);
+                                 std::size_t offset{0};
+                                 while (!done.load())
+                                 {
+                                     a.read(dst.data(), block_size, offset);
+                                     for (std::size_t k = 1; k < block_size; ++k)
+                                     {
+                                         if (dst.data()[k] != dst.data()[0])
+                                         {
+                                             torn = true;
+                                         }
+                                     }
+                                     offset = (offset + block_size) % (num_blocks * block_size);
+                                 } });
+    }
+
+    aligned_array<std::uint64_t> src(block_size);
+    for (std::uint64_t k = 0; k < 20000; ++k)
+    {
+        fill_array(src, k);
+        a.write(src.data(), block_size);
+    }
+    done = true;
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    REQUIRE_FALSE(torn.load());
+}
+
+TEST_CASE("left_right_solution runs in the benchmark")
+{
+    using solution = left_right_solution<std::uint64_t, 16>;
+    const benchmark_results results = run_benchmark<solution, std::uint64_t, 16>(8, 16, 2, 2000);
+    REQUIRE(results.times.size() == 3);
+    REQUIRE(results.read_latency.count() == 2 * 2000);
+}
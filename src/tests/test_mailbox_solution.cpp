@@ -0,0 +1,98 @@
+#include <catch2/catch_test_macros.hpp>
+#include <mailbox_solution.hpp>
+#include <benchmark.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("mailbox_solution is correctly implemented")
+{
+    constexpr std::size_t num_slots = 4;
+    constexpr std::size_t block_size = 64;
+    constexpr std::size_t alignment = 16;
+    mailbox_solution<std::uint64_t, alignment> a(num_slots, block_size);
+    aligned_array<std::uint64_t> src(block_size);
+    aligned_array<std::uint64_t> dst(block_size);
+    a.fill(0);
+
+    SECTION("calls catch wrong input")
+    {
+        REQUIRE_THROWS_AS((mailbox_solution<std::uint64_t, alignment>(1, block_size)), std::runtime_error);
+        REQUIRE_THROWS_AS(a.write(nullptr, block_size), std::runtime_error);
+        REQUIRE_THROWS_AS(a.write(src.data(), 2), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read(nullptr, block_size, 0), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read(dst.data(), 2, 0), std::runtime_error);
+    }
+
+    SECTION("readers get the newest block whatever the offset")
+    {
+        for (std::uint64_t k = 1; k < 5 * num_slots; ++k)
+        {
+            fill_array(src, k);
+            a.write(src.data(), block_size);
+            a.read(dst.data(), block_size, 0);
+            REQUIRE(std::memcmp(src.data(), dst.data(), block_size * sizeof(std::uint64_t)) == 0);
+            a.read(dst.data(), block_size, 3 * block_size);
+            REQUIRE(dst.data()[block_size - 1] == k);
+        }
+    }
+}
+
+TEST_CASE("mailbox_solution readers see whole blocks in publication order")
+{
+    constexpr std::size_t readers = 3;
+    constexpr std::size_t block_size = 256;
+    mailbox_solution<std::uint64_t, 16> a(readers + 2, block_size);
+    a.fill(0);
+    std::atomic<bool> done{false};
+    std::atomic<bool> torn{false};
+    std::atomic<bool> backwards{false};
+
+    std::vector<std::thread> threads;
+    for (std::size_t r = 0; r < readers; ++r)
+    {
+        threads.emplace_back([&]
+                             {
+                                 aligned_array<std::uint64_t> dst(block_size);
+                                 std::uint64_t newest{0};
+                                 while (!done.load())
+                                 {
+                                     a.read(dst.data(), block_size, 0);
+                                     for (std::size_t k = 1; k < block_size; ++k)
+                                     {
+                                         if (dst.data()[k] != dst.data()[0])
+                                         {
+                                             torn = true;
+                                         }
+                                     }
+                                     if (dst.data()[0] < newest)
+                                     {
+                                         backwards = true;
+                                     }
+                                     newest = dst.data()[0];
+                                 } });
+    }
+
+    aligned_array<std::uint64_t> src(block_size);
+    for (std::uint64_t k = 1; k <= 20000; ++k)
+    {
+        fill_array(src, k);
+        a.write(src.data(), block_size);
+    }
+    done = true;
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    REQUIRE_FALSE(torn.load());
+    REQUIRE_FALSE(backwards.load());
+}
+
+TEST_CASE("mailbox_solution runs in the benchmark")
+{
+    using solution = mailbox_solution<std::uint64_t, 16>;
+    const benchmark_results results = run_benchmark<solution, std::uint64_t, 16>(5, 16, 3, 2000);
+    REQUIRE(results.times.size() == 4);
+    REQUIRE(results.read_latency.count() == 3 * 2000);
+}
@@ -0,0 +1,121 @@
+#include <catch2/catch_test_macros.hpp>
+#include <mpmc_solution.hpp>
+#include <synchronised_solution.hpp>
+#include <benchmark.hpp>
+
+#include <thread>
+#include <vector>
+
+TEST_CASE("mpmc_solution is correctly implemented")
+{
+    constexpr std::size_t num_blocks = 4;
+    constexpr std::size_t block_size = 16;
+    constexpr std::size_t alignment = 16;
+    mpmc_solution<std::uint64_t, alignment> a(num_blocks, block_size);
+    aligned_array<std::uint64_t> src(block_size);
+    aligned_array<std::uint64_t> dst(block_size);
+    consumer_cursor consumer;
+
+    SECTION("calls catch wrong input")
+    {
+        REQUIRE_THROWS_AS(a.write(nullptr, block_size), std::runtime_error);
+        REQUIRE_THROWS_AS(a.write(src.data(), 2), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read(nullptr, block_size, 0), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read_next(dst.data(), 2, consumer), std::runtime_error);
+    }
+
+    SECTION("a single producer behaves like the SeqLock")
+    {
+        REQUIRE(a.read_next(dst.data(), block_size, consumer).status == read_status::not_ready);
+        constexpr std::size_t written = 2 * num_blocks + 1;
+        for (std::uint64_t k = 0; k < written; ++k)
+        {
+            fill_array(src, k);
+            a.write(src.data(), block_size);
+        }
+        REQUIRE(a.head() == written);
+
+        a.read(dst.data(), block_size, 0);
+        REQUIRE(dst.data()[0] == written - 1);
+
+        const read_result r = a.read_next(dst.data(), block_size, consumer);
+        REQUIRE(r.status == read_status::ok);
+        REQUIRE(r.lost == written - num_blocks);
+        REQUIRE(dst.data()[0] == written - num_blocks);
+    }
+}
+
+TEST_CASE("mpmc_solution commits the blocks of several producers in order")
+{
+    constexpr std::size_t num_blocks = 64;
+    constexpr std::size_t block_size = 8;
+    constexpr std::size_t producers = 4;
+    constexpr std::size_t per_producer = 2000;
+    mpmc_solution<std::uint64_t, 16> a(num_blocks, block_size);
+
+    std::vector<std::thread> threads;
+    for (std::size_t p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&a, p]
+                             {
+                                 aligned_array<std::uint64_t> src(block_size);
+                                 for (std::uint64_t k = 0; k < per_producer; ++k)
+                                 {
+                                     fill_array(src, (p << 32) | k);
+                                     a.write(src.data(), block_size);
+                                 } });
+    }
+
+    // every block read whole, each producer's blocks in the order it wrote them
+    aligned_array<std::uint64_t> dst(block_size);
+    consumer_cursor consumer;
+    std::vector<std::uint64_t> next(producers, 0);
+    bool whole{true};
+    bool ordered{true};
+    std::size_t received{0};
+    while (received + consumer.lost < producers * per_producer)
+    {
+        if (a.read_next(dst.data(), block_size, consumer).status != read_status::ok)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ++received;
+        for (std::size_t k = 1; k < block_size; ++k)
+        {
+            whole = whole && dst.data()[k] == dst.data()[0];
+        }
+        const std::size_t p = dst.data()[0] >> 32;
+        const std::uint64_t k = dst.data()[0] & 0xffffffff;
+        ordered = ordered && p < producers && k >= next[p];
+        if (p < producers)
+        {
+            next[p] = k + 1;
+        }
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    REQUIRE(whole);
+    REQUIRE(ordered);
+    REQUIRE(a.head() == producers * per_producer);
+}
+
+TEST_CASE("benchmarks run several producers only on multi-producer solutions")
+{
+    using mpmc = mpmc_solution<std::uint64_t, 16>;
+    using serialised = serialised_producers<exclusive_solution<std::uint64_t, 16>>;
+    using single = seqlock_solution<std::uint64_t, 16>;
+
+    STATIC_REQUIRE(multi_producer_solution<mpmc>);
+    STATIC_REQUIRE(multi_producer_solution<serialised>);
+    STATIC_REQUIRE_FALSE(multi_producer_solution<single>);
+    STATIC_REQUIRE_FALSE(batch_solution<serialised_producers<single>, std::uint64_t>);
+
+    const benchmark_results results = run_benchmark<mpmc, std::uint64_t, 16>(8, 16, 2, 3000, 1, {}, 1, placement::none, 3);
+    REQUIRE(results.times.size() == 3);
+    REQUIRE(results.write_latency.count() > 0);
+    REQUIRE(run_benchmark<serialised, std::uint64_t, 16>(8, 16, 1, 3000, 1, {}, 1, placement::none, 2).times.size() == 2);
+    REQUIRE_THROWS_AS((run_benchmark<single, std::uint64_t, 16>(8, 16, 1, 1000, 1, {}, 1, placement::none, 2)), std::runtime_error);
+}
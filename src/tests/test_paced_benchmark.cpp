@@ -0,0 +1,72 @@
+#include <catch2/catch_test_macros.hpp>
+#include <paced_benchmark.hpp>
+#include <seqlock_solution.hpp>
+#include <synchronised_solution.hpp>
+
+#include <algorithm>
+#include <string>
+
+namespace
+{
+    auto metric(const benchmark_results &results, const std::string &name) -> double
+    {
+        const auto found = std::find_if(results.metrics.begin(), results.metrics.end(), [&name](const auto &m)
+                                        { return m.first == name; });
+        REQUIRE(found != results.metrics.end());
+        return found->second;
+    }
+}
+
+TEST_CASE("paced options derive the period from the sample rate")
+{
+    paced_options options;
+    options.sample_rate = 48000.0;
+    options.deadline_fraction = 0.5;
+    REQUIRE(options.period_ns(48) == 1000000);
+    REQUIRE(options.deadline_ns(48) == 500000);
+    options.sample_rate = 192000.0;
+    REQUIRE(options.period_ns(192) == 1000000);
+}
+
+TEST_CASE("sleep_until_ns never wakes before the deadline")
+{
+    for (const std::uint64_t spin : {std::uint64_t{0}, std::uint64_t{50000}})
+    {
+        const std::uint64_t deadline = steady_now_ns() + 2000000;
+        sleep_until_ns(deadline, spin);
+        REQUIRE(steady_now_ns() >= deadline);
+    }
+    const std::uint64_t now = steady_now_ns();
+    sleep_until_ns(now - 1000, 50000); // a deadline in the past returns at once
+    REQUIRE(steady_now_ns() - now < 1000000000);
+}
+
+TEST_CASE("paced benchmark accounts for every block and deadline")
+{
+    constexpr std::size_t num_blocks = 10;
+    constexpr std::size_t block_size = 16;
+    constexpr std::size_t readers = 2;
+    paced_options options;
+    options.sample_rate = 16000.0; // one block per millisecond
+    options.jitter_ns = 100000;
+    options.duration = std::chrono::milliseconds(50);
+    const std::size_t cycles = 50;
+
+    SECTION("SeqLock")
+    {
+        const benchmark_results results = run_paced_benchmark<seqlock_solution<std::uint64_t, 16>, std::uint64_t, 16>(num_blocks, block_size, readers, options);
+        REQUIRE(results.write_latency.count() == cycles);
+        REQUIRE(results.read_latency.count() == readers * cycles);
+        REQUIRE(results.lost.size() == readers);
+        REQUIRE(metric(results, "period_ns") == 1000000.0);
+        REQUIRE(metric(results, "deadline_misses") <= static_cast<double>(readers * cycles));
+        REQUIRE(metric(results, "wakeup_jitter_max_ns") >= metric(results, "wakeup_jitter_p50_ns"));
+    }
+
+    SECTION("Mutex")
+    {
+        const benchmark_results results = run_paced_benchmark<exclusive_solution<float, 16>, float, 16>(num_blocks, block_size, readers, options);
+        REQUIRE(results.read_latency.count() == readers * cycles);
+        REQUIRE(metric(results, "deadline_miss_percent") <= 100.0);
+    }
+}
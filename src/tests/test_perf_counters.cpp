@@ -0,0 +1,78 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <benchmark.hpp>
+#include <perf_counters.hpp>
+
+TEST_CASE("perf counters degrade gracefully")
+{
+    SECTION("disabled counters open nothing and count nothing")
+    {
+        perf_counters::enable(false);
+        perf_counters perf;
+        perf.start();
+        perf.stop();
+        REQUIRE_FALSE(perf.available());
+        REQUIRE_FALSE(perf.read().any());
+    }
+
+    SECTION("enabled counters count a loop where the kernel allows it")
+    {
+        perf_counters::enable(true);
+        perf_counters perf;
+        volatile std::uint64_t sum{0};
+        perf.start();
+        for (std::uint64_t k = 0; k < 100000; ++k)
+        {
+            sum = sum + k;
+        }
+        perf.stop();
+        const perf_counts counts = perf.read();
+        perf_counters::enable(false);
+
+        REQUIRE(counts.any() == perf.available());
+        if (counts.valid[static_cast<std::size_t>(perf_event::instructions)])
+        {
+            REQUIRE(counts[perf_event::instructions] >= 100000.0);
+        }
+    }
+
+    SECTION("counts of several threads are added, an event stays valid only if every thread counted it")
+    {
+        perf_counts a;
+        perf_counts b;
+        a.values = {100.0, 200.0, 0.0, 0.0, 0.0};
+        a.valid = {true, true, false, false, false};
+        b.values = {50.0, 0.0, 0.0, 0.0, 0.0};
+        b.valid = {true, false, false, false, false};
+        a.add(b);
+        REQUIRE(a[perf_event::cycles] == 150.0);
+        REQUIRE(a.valid[0]);
+        REQUIRE_FALSE(a.valid[1]);
+    }
+
+    SECTION("counts are reported per block")
+    {
+        perf_counts writer_counts;
+        writer_counts.values[0] = 1000.0;
+        writer_counts.valid[0] = true;
+        std::vector<perf_counts> reader_counts(2, writer_counts);
+
+        benchmark_results off;
+        add_perf_metrics(off, writer_counts, reader_counts, 10);
+        REQUIRE(off.metrics.empty());
+
+        perf_counters::enable(true);
+        benchmark_results on;
+        add_perf_metrics(on, writer_counts, reader_counts, 10);
+        benchmark_results none;
+        add_perf_metrics(none, perf_counts{}, {perf_counts{}}, 10);
+        perf_counters::enable(false);
+
+        REQUIRE(on.metrics.size() == 2);
+        REQUIRE(on.metrics[0].first == "writer_cycles_per_block");
+        REQUIRE(on.metrics[0].second == Catch::Approx(100.0));
+        REQUIRE(on.metrics[1].first == "reader_cycles_per_block");
+        REQUIRE(on.metrics[1].second == Catch::Approx(100.0));
+        REQUIRE(none.labels.back() == std::make_pair(std::string("perf_counters"), std::string("unavailable")));
+    }
+}
@@ -0,0 +1,106 @@
+#include <catch2/catch_test_macros.hpp>
+#include <pipeline_benchmark.hpp>
+#include <seqlock_solution.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    auto metric(const benchmark_results &results, const std::string &name) -> double
+    {
+        const auto found = std::find_if(results.metrics.begin(), results.metrics.end(), [&name](const auto &m)
+                                        { return m.first == name; });
+        REQUIRE(found != results.metrics.end());
+        return found->second;
+    }
+
+    using ring = seqlock_solution<std::uint64_t, 16>;
+
+    template <typename data_type>
+    concept pipeline_data = requires(const pipeline_config &config) {
+        run_pipeline_benchmark<seqlock_solution<data_type, 16>, data_type, 16>(config, 1, 1, 1);
+    };
+}
+
+TEST_CASE("pipeline config parses linear and fan-out/fan-in graphs")
+{
+    const pipeline_config linear = pipeline_config::parse("capture; filter <- capture; sink<-filter");
+    REQUIRE(linear.stages.size() == 3);
+    REQUIRE(linear.stages[2].name == "sink");
+    REQUIRE(linear.stages[2].inputs == std::vector<std::size_t>{1});
+    REQUIRE(linear.has_consumers(1));
+    REQUIRE_FALSE(linear.has_consumers(2));
+
+    const pipeline_config diamond = pipeline_config::parse("capture;left<-capture;right<-capture;sink<-left+right");
+    REQUIRE(diamond.stages[3].inputs == std::vector<std::size_t>{1, 2});
+    REQUIRE(diamond.find("right") == 2);
+    REQUIRE(diamond.find("missing") == 4);
+
+    REQUIRE_THROWS_AS(pipeline_config::parse("capture"), std::runtime_error);
+    REQUIRE_THROWS_AS(pipeline_config::parse("capture;sink<-filter;filter<-capture"), std::runtime_error);
+    REQUIRE_THROWS_AS(pipeline_config::parse("capture;capture<-capture"), std::runtime_error);
+    REQUIRE_THROWS_AS(pipeline_config::parse("capture;other;sink<-capture"), std::runtime_error);
+    REQUIRE_THROWS_AS(pipeline_config::parse("capture<-sink;sink"), std::runtime_error);
+}
+
+TEST_CASE("pipeline stages account for every source block")
+{
+    constexpr std::size_t cycles = 300;
+    pipeline_options options;
+    options.period_ns = 20000; // slow enough for the stages to keep up most of the time
+
+    SECTION("linear")
+    {
+        const pipeline_config config = pipeline_config::parse("capture;filter<-capture;features<-filter;sink<-features");
+        const benchmark_results results = run_pipeline_benchmark<ring, std::uint64_t, 16>(config, 16, 64, cycles, options);
+        REQUIRE(results.times.size() == 4);
+        REQUIRE(results.lost.size() == 3);
+        REQUIRE(results.write_latency.count() == cycles);
+        // the first stage reads or loses every block of the source
+        REQUIRE(results.read_latency.count() >= cycles - results.lost[0]);
+        REQUIRE(metric(results, "end_to_end_max_ns") > 0);
+        REQUIRE(metric(results, "stage_filter_blocks_per_s") > 0);
+    }
+
+    SECTION("fan-out and fan-in")
+    {
+        const pipeline_config config = pipeline_config::parse("capture;left<-capture;right<-capture;sink<-left+right");
+        const benchmark_results results = run_pipeline_benchmark<ring, std::uint64_t, 16>(config, 16, 64, cycles, options);
+        REQUIRE(results.times.size() == 4);
+        REQUIRE(metric(results, "end_to_end_p50_ns") > 0);
+        REQUIRE(metric(results, "stage_sink_mean_backlog") >= 0);
+        for (const auto &label : results.labels)
+        {
+            if (label.first == "pipeline")
+            {
+                REQUIRE(label.second == config.spec);
+            }
+        }
+    }
+}
+
+TEST_CASE("pipeline sums the inputs of a fan-in stage")
+{
+    const pipeline_config config = pipeline_config::parse("capture;a<-capture;b<-capture;join<-a+b;sink<-join");
+    // the rings are longer than the run, so no block is ever overwritten
+    const benchmark_results results = run_pipeline_benchmark<ring, std::uint64_t, 16>(config, 64, 4, 50, pipeline_options{100000});
+    std::size_t lost{0};
+    for (const auto l : results.lost)
+    {
+        lost += l;
+    }
+    REQUIRE(lost == 0);
+    REQUIRE(results.read_latency.count() == 4 * 50);
+    REQUIRE(metric(results, "stage_join_max_backlog") < 50);
+}
+
+TEST_CASE("pipelines only carry block numbers in 64-bit integers")
+{
+    STATIC_REQUIRE(pipeline_data<std::uint64_t>);
+    STATIC_REQUIRE(pipeline_data<std::int64_t>);
+    STATIC_REQUIRE_FALSE(pipeline_data<float>);
+    STATIC_REQUIRE_FALSE(pipeline_data<double>);
+    STATIC_REQUIRE_FALSE(pipeline_data<std::uint32_t>);
+}
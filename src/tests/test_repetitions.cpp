@@ -0,0 +1,47 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include <repetitions.hpp>
+
+TEST_CASE("repeated runs are summarised")
+{
+    SECTION("a single sample has no spread")
+    {
+        const sample_statistics s = summarise({5.0});
+        REQUIRE(s.mean == Catch::Approx(5.0));
+        REQUIRE(s.stddev == 0.0);
+        REQUIRE(s.ci95 == 0.0);
+    }
+
+    SECTION("confidence interval uses Student's t")
+    {
+        const sample_statistics s = summarise({1.0, 2.0, 3.0, 4.0, 5.0});
+        REQUIRE(s.mean == Catch::Approx(3.0));
+        REQUIRE(s.stddev == Catch::Approx(1.5811388));
+        REQUIRE(s.ci95 == Catch::Approx(2.776 * 1.5811388 / 2.2360680));
+    }
+
+    SECTION("runs are averaged, losses summed and histograms merged")
+    {
+        benchmark_results a{{10.0, 20.0, 30.0}, {1, 2}};
+        benchmark_results b{{30.0, 40.0, 50.0}, {3, 4}};
+        a.metrics.emplace_back("messages_per_s", 100.0);
+        b.metrics.emplace_back("messages_per_s", 300.0);
+        a.write_latency.record(10);
+        b.write_latency.record(20);
+
+        const repeated_results r = combine_repetitions({a, b});
+        REQUIRE(r.repetitions == 2);
+        REQUIRE(r.combined.times == std::vector<double>{20.0, 30.0, 40.0});
+        REQUIRE(r.combined.lost == std::vector<std::size_t>{4, 6});
+        REQUIRE(r.combined.metrics.front().second == Catch::Approx(200.0));
+        REQUIRE(r.combined.write_latency.count() == 2);
+        REQUIRE(r.writer.mean == Catch::Approx(20.0));
+        REQUIRE(r.readers.mean == Catch::Approx(35.0));
+    }
+
+    SECTION("runs of different shapes cannot be combined")
+    {
+        REQUIRE_THROWS_AS(combine_repetitions({benchmark_results{{1.0, 2.0}}, benchmark_results{{1.0}}}), std::runtime_error);
+        REQUIRE_THROWS_AS(combine_repetitions({}), std::runtime_error);
+    }
+}
@@ -1,6 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
 #include <storage.hpp>
 #include <seqlock_solution.hpp>
+#include <benchmark.hpp>
 
 TEST_CASE("seqlock_solution is correctly implemented")
 {
@@ -32,4 +34,221 @@ TEST_CASE("seqlock_solution is correctly implemented")
             REQUIRE(std::memcmp(src.data(), dst.data(), block_size * sizeof(std::uint64_t)) == 0);
         }
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("seqlock_solution read_view exposes blocks without copying")
+{
+    constexpr std::size_t num_blocks = 4;
+    constexpr std::size_t block_size = 16;
+    constexpr std::size_t alignment = 16;
+    seqlock_solution<std::uint64_t, alignment> a(num_blocks, block_size);
+    aligned_array<std::uint64_t> src(block_size);
+    fill_array(src, std::uint64_t{3});
+
+    SECTION("read_view catches wrong offsets")
+    {
+        const auto ignore = [](std::span<const std::uint64_t>) {};
+        REQUIRE_THROWS_AS(a.read_view(1, ignore), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read_view(num_blocks * block_size, ignore), std::runtime_error);
+    }
+
+    SECTION("the visitor sees the written block")
+    {
+        a.write(src.data(), block_size);
+        std::uint64_t sum{0};
+        std::size_t length{0};
+        const bool valid = a.read_view(0, [&](std::span<const std::uint64_t> block)
+                                       {
+                                           length = block.size();
+                                           for (const auto v : block)
+                                           {
+                                               sum += v;
+                                           } });
+        REQUIRE(valid);
+        REQUIRE(length == block_size);
+        REQUIRE(sum == 3 * block_size);
+    }
+
+    SECTION("a write during the visit invalidates the result")
+    {
+        a.write(src.data(), block_size);
+        for (std::size_t k = 0; k < num_blocks - 1; ++k)
+        {
+            a.write(src.data(), block_size);
+        }
+        const bool valid = a.read_view(0, [&](std::span<const std::uint64_t>)
+                                       { a.write(src.data(), block_size); });
+        REQUIRE_FALSE(valid);
+    }
+}
+
+TEST_CASE("seqlock_solution consumers follow the published sequence")
+{
+    constexpr std::size_t num_blocks = 4;
+    constexpr std::size_t block_size = 16;
+    constexpr std::size_t alignment = 16;
+    seqlock_solution<std::uint64_t, alignment> a(num_blocks, block_size);
+    aligned_array<std::uint64_t> src(block_size);
+    aligned_array<std::uint64_t> dst(block_size);
+    consumer_cursor consumer;
+
+    SECTION("read_next catches wrong input")
+    {
+        REQUIRE_THROWS_AS(a.read_next(nullptr, block_size, consumer), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read_next(dst.data(), 2, consumer), std::runtime_error);
+    }
+
+    SECTION("nothing is ready before the first write")
+    {
+        REQUIRE(a.head() == 0);
+        REQUIRE(a.read_next(dst.data(), block_size, consumer).status == read_status::not_ready);
+    }
+
+    SECTION("blocks are read in the order they were written")
+    {
+        for (std::uint64_t k = 0; k < num_blocks - 1; ++k)
+        {
+            fill_array(src, k);
+            a.write(src.data(), block_size);
+        }
+        for (std::uint64_t k = 0; k < num_blocks - 1; ++k)
+        {
+            const read_result r = a.read_next(dst.data(), block_size, consumer);
+            REQUIRE(r.status == read_status::ok);
+            REQUIRE(r.lost == 0);
+            REQUIRE(dst.data()[0] == k);
+        }
+        REQUIRE(a.read_next(dst.data(), block_size, consumer).status == read_status::not_ready);
+        REQUIRE(consumer.next == num_blocks - 1);
+    }
+
+    SECTION("overruns are detected and reported")
+    {
+        constexpr std::size_t written = 3 * num_blocks + 1;
+        for (std::uint64_t k = 0; k < written; ++k)
+        {
+            fill_array(src, k);
+            a.write(src.data(), block_size);
+        }
+        const read_result r = a.read_next(dst.data(), block_size, consumer);
+        REQUIRE(r.status == read_status::ok);
+        REQUIRE(r.lost == written - num_blocks);
+        REQUIRE(dst.data()[0] == written - num_blocks);
+        REQUIRE(consumer.lost == written - num_blocks);
+        for (std::uint64_t k = written - num_blocks + 1; k < written; ++k)
+        {
+            REQUIRE(a.read_next(dst.data(), block_size, consumer).status == read_status::ok);
+            REQUIRE(dst.data()[block_size - 1] == k);
+        }
+        REQUIRE(a.read_next(dst.data(), block_size, consumer).status == read_status::not_ready);
+    }
+}
+
+TEST_CASE("seqlock_solution moves batches of blocks")
+{
+    constexpr std::size_t num_blocks = 5;
+    constexpr std::size_t block_size = 16;
+    constexpr std::size_t alignment = 16;
+    constexpr std::size_t batch = 3;
+    seqlock_solution<std::uint64_t, alignment> a(num_blocks, block_size);
+    aligned_array<std::uint64_t> src(batch * block_size);
+    aligned_array<std::uint64_t> dst(batch * block_size);
+    for (std::size_t k = 0; k < src.size(); ++k)
+    {
+        src.data()[k] = k;
+    }
+
+    SECTION("batch calls catch wrong input")
+    {
+        REQUIRE_THROWS_AS(a.write_batch(nullptr, block_size), std::runtime_error);
+        REQUIRE_THROWS_AS(a.write_batch(src.data(), block_size + 1), std::runtime_error);
+        REQUIRE_THROWS_AS(a.write_batch(src.data(), (num_blocks + 1) * block_size), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read_batch(dst.data(), block_size, 1), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read_batch(dst.data(), block_size, num_blocks * block_size), std::runtime_error);
+    }
+
+    SECTION("batches wrap around the end of the ring")
+    {
+        a.write_batch(src.data(), batch * block_size);
+        a.write_batch(src.data(), batch * block_size);
+        REQUIRE(a.head() == 2 * batch);
+
+        a.read_batch(dst.data(), batch * block_size, batch * block_size);
+        REQUIRE(std::memcmp(src.data(), dst.data(), batch * block_size * sizeof(std::uint64_t)) == 0);
+
+        consumer_cursor consumer{batch};
+        for (std::size_t k = 0; k < batch; ++k)
+        {
+            REQUIRE(a.read_next(dst.data(), block_size, consumer).status == read_status::ok);
+            REQUIRE(dst.data()[0] == k * block_size);
+        }
+    }
+}
+
+TEST_CASE("throughput benchmark delivers every block to every reader")
+{
+    using solution = seqlock_solution<std::uint64_t, 16>;
+    const benchmark_results results = run_throughput_benchmark<solution, std::uint64_t, 16>(8, 16, 2, std::chrono::milliseconds(50));
+    REQUIRE(results.times.size() == 3);
+    REQUIRE(results.lost == std::vector<std::size_t>{0, 0});
+    REQUIRE(results.lag.size() == 2);
+    REQUIRE(results.lag[0] < 8.0);
+    REQUIRE(results.metrics.size() == 4);
+    REQUIRE(results.metrics[1].first == "messages_per_s");
+    REQUIRE(results.metrics[1].second > 0.0);
+}
+
+TEMPLATE_TEST_CASE("seqlock_solution sequence layouts keep blocks apart", "",
+                   (inline_seqlock_solution<std::uint64_t, 16>),
+                   (global_seqlock_solution<std::uint64_t, 16>),
+                   (seqlock_solution<std::uint64_t, 64, memcpy_copy, busy_spin, sequence_layout::inline_header>))
+{
+    constexpr std::size_t num_blocks = 4;
+    constexpr std::size_t block_size = 13; // inline slots are padded to whole cache lines
+    TestType a(num_blocks, block_size);
+    a.fill(7); // an odd value would leave an inline sequence busy forever if fill overwrote it
+    aligned_array<std::uint64_t> src(block_size);
+    aligned_array<std::uint64_t> dst(block_size);
+
+    STATIC_REQUIRE_FALSE(batch_solution<TestType, std::uint64_t>);
+
+    SECTION("every block reads back what was written into it")
+    {
+        for (std::uint64_t k = 0; k < 2 * num_blocks; ++k)
+        {
+            fill_array(src, k);
+            a.write(src.data(), block_size);
+        }
+        for (std::uint64_t k = 0; k < num_blocks; ++k)
+        {
+            a.read(dst.data(), block_size, k * block_size);
+            REQUIRE(dst.data()[0] == num_blocks + k);
+            REQUIRE(dst.data()[block_size - 1] == num_blocks + k);
+        }
+    }
+
+    SECTION("read_next follows the sequence and reports lost blocks")
+    {
+        consumer_cursor consumer;
+        for (std::uint64_t k = 0; k < num_blocks + 2; ++k)
+        {
+            fill_array(src, k);
+            a.write(src.data(), block_size);
+        }
+        const read_result result = a.read_next(dst.data(), block_size, consumer);
+        REQUIRE(result.status == read_status::ok);
+        REQUIRE(result.lost == 2);
+        REQUIRE(dst.data()[0] == 2);
+        while (a.read_next(dst.data(), block_size, consumer).status == read_status::ok)
+        {
+        }
+        REQUIRE(consumer.next == num_blocks + 2);
+        REQUIRE(dst.data()[block_size - 1] == num_blocks + 1);
+    }
+
+    SECTION("the layout runs in the benchmark")
+    {
+        const benchmark_results results = run_benchmark<TestType, std::uint64_t, 16>(num_blocks, block_size, 2, 2000);
+        REQUIRE(results.read_latency.count() == 2 * 2000);
+    }
+}
@@ -0,0 +1,90 @@
+#include <catch2/catch_test_macros.hpp>
+
+#if defined(__linux__)
+
+#include <aligned_array.hpp>
+#include <shm_solution.hpp>
+#include <shm_benchmark.hpp>
+#include <string>
+#include <unistd.h>
+
+TEST_CASE("shm_seqlock_solution is correctly implemented")
+{
+    constexpr std::size_t num_blocks = 4;
+    constexpr std::size_t block_size = 8;
+    constexpr std::size_t alignment = 64;
+    using solution = shm_seqlock_solution<std::uint32_t, alignment>;
+    const std::string name = "/spmc_test_" + std::to_string(::getpid());
+
+    solution writer(name, num_blocks, block_size);
+    aligned_array<std::uint32_t, alignment> src(block_size);
+    aligned_array<std::uint32_t, alignment> dst(block_size);
+
+    SECTION("creating an existing region or attaching to a missing one throws")
+    {
+        REQUIRE_THROWS_AS(solution(name, num_blocks, block_size), std::system_error);
+        REQUIRE_THROWS_AS(solution(name + "_missing"), std::system_error);
+    }
+
+    SECTION("attaching with a different data type throws")
+    {
+        using other = shm_seqlock_solution<std::uint64_t, alignment>;
+        REQUIRE_THROWS_AS(other(name), std::runtime_error);
+    }
+
+    SECTION("consumers see the geometry and the blocks written by the writer")
+    {
+        solution reader(name);
+        REQUIRE(writer.consumers() == 1);
+        REQUIRE(reader.num_blocks() == num_blocks);
+        REQUIRE(reader.block_size() == block_size);
+        REQUIRE_THROWS_AS(reader.write(src.data(), block_size), std::runtime_error);
+
+        fill_array(src, std::uint32_t{7});
+        writer.write(src.data(), block_size);
+        REQUIRE(reader.head() == 1);
+        reader.read(dst.data(), block_size, 0);
+        REQUIRE(dst.data()[block_size - 1] == 7);
+
+        reader.detach();
+        REQUIRE(writer.consumers() == 0);
+    }
+
+    SECTION("read_next follows the writer and reports overruns")
+    {
+        solution reader(name);
+        consumer_cursor consumer;
+        REQUIRE(reader.read_next(dst.data(), block_size, consumer).status == read_status::not_ready);
+
+        for (std::uint32_t k = 0; k < num_blocks + 2; ++k)
+        {
+            fill_array(src, k);
+            writer.write(src.data(), block_size);
+        }
+        const read_result r = reader.read_next(dst.data(), block_size, consumer);
+        REQUIRE(r.status == read_status::ok);
+        REQUIRE(r.lost == 2);
+        REQUIRE(dst.data()[0] == 2);
+        REQUIRE(consumer.next == 3);
+    }
+
+    SECTION("the writer is alive until it detaches")
+    {
+        solution reader(name);
+        REQUIRE(reader.writer_alive(std::chrono::seconds(1)));
+        writer.detach();
+        REQUIRE_FALSE(reader.writer_alive(std::chrono::seconds(1)));
+        REQUIRE_THROWS_AS(solution(name), std::system_error);
+    }
+}
+
+TEST_CASE("shared memory benchmark runs readers in separate processes")
+{
+    const benchmark_results results = run_shm_benchmark<std::uint64_t, 16>(8, 16, 2, 1000);
+    REQUIRE(results.times.size() == 3);
+    REQUIRE(results.lost.size() == 2);
+    REQUIRE(results.write_latency.count() == 999);
+    REQUIRE(results.read_latency.count() + results.lost[0] + results.lost[1] == 2 * 1000);
+}
+
+#endif
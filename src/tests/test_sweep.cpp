@@ -0,0 +1,41 @@
+#include <catch2/catch_test_macros.hpp>
+#include <sweep.hpp>
+
+#include <stdexcept>
+
+TEST_CASE("sweep axes are parsed from the command line")
+{
+    using values = std::vector<std::size_t>;
+
+    SECTION("single values and lists keep their order")
+    {
+        REQUIRE(sweep::parse_sizes("10") == values{10});
+        REQUIRE(sweep::parse_sizes("3, 1,2") == values{3, 1, 2});
+    }
+
+    SECTION("ranges add or multiply the step")
+    {
+        REQUIRE(sweep::parse_sizes("1:5") == values{1, 2, 3, 4, 5});
+        REQUIRE(sweep::parse_sizes("0:10:+4") == values{0, 4, 8});
+        REQUIRE(sweep::parse_sizes("16:128:x2") == values{16, 32, 64, 128});
+        REQUIRE(sweep::parse_sizes("16:100:*4,7") == values{16, 64, 7});
+    }
+
+    SECTION("invalid axes are rejected")
+    {
+        REQUIRE_THROWS_AS(sweep::parse_sizes(""), std::runtime_error);
+        REQUIRE_THROWS_AS(sweep::parse_sizes("abc"), std::runtime_error);
+        REQUIRE_THROWS_AS(sweep::parse_sizes("-1"), std::runtime_error);
+        REQUIRE_THROWS_AS(sweep::parse_sizes("5:1"), std::runtime_error);
+        REQUIRE_THROWS_AS(sweep::parse_sizes("1:5:0"), std::runtime_error);
+        REQUIRE_THROWS_AS(sweep::parse_sizes("0:8:x2"), std::runtime_error);
+        REQUIRE_THROWS_AS(sweep::parse_sizes("1:2:3:4"), std::runtime_error);
+    }
+
+    SECTION("implementations are selected by name or all")
+    {
+        REQUIRE(sweep::selected("seqlock,mutex", "mutex"));
+        REQUIRE_FALSE(sweep::selected("seqlock,mutex", "shared-mutex"));
+        REQUIRE(sweep::selected("all", "zmq"));
+    }
+}
@@ -0,0 +1,63 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <aligned_array.hpp>
+#include <synchronised_solution.hpp>
+#include <benchmark.hpp>
+
+TEMPLATE_TEST_CASE("synchronised_solution is correctly implemented", "",
+                   (shared_solution<std::uint64_t, 16>),
+                   (exclusive_solution<std::uint64_t, 16>))
+{
+    constexpr std::size_t num_blocks = 5;
+    constexpr std::size_t block_size = 16;
+    constexpr std::size_t batch = 3;
+    TestType a(num_blocks, block_size);
+    aligned_array<std::uint64_t> src(batch * block_size);
+    aligned_array<std::uint64_t> dst(batch * block_size);
+    for (std::size_t k = 0; k < src.size(); ++k)
+    {
+        src.data()[k] = k;
+    }
+
+    SECTION("write and read catch wrong input")
+    {
+        REQUIRE_THROWS_AS(a.write(nullptr, block_size), std::runtime_error);
+        REQUIRE_THROWS_AS(a.write(src.data(), 2), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read(nullptr, block_size, 0), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read(dst.data(), 2, 0), std::runtime_error);
+    }
+
+    SECTION("batch calls catch wrong input")
+    {
+        REQUIRE_THROWS_AS(a.write_batch(nullptr, block_size), std::runtime_error);
+        REQUIRE_THROWS_AS(a.write_batch(src.data(), block_size + 1), std::runtime_error);
+        REQUIRE_THROWS_AS(a.write_batch(src.data(), (num_blocks + 1) * block_size), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read_batch(dst.data(), block_size, 1), std::runtime_error);
+    }
+
+    SECTION("writes and reads data")
+    {
+        a.write(src.data(), block_size);
+        a.read(dst.data(), block_size, 0);
+        REQUIRE(std::memcmp(src.data(), dst.data(), block_size * sizeof(std::uint64_t)) == 0);
+    }
+
+    SECTION("batches wrap around the end of the ring")
+    {
+        a.write_batch(src.data(), batch * block_size);
+        a.write_batch(src.data(), batch * block_size);
+        a.read_batch(dst.data(), batch * block_size, batch * block_size);
+        REQUIRE(std::memcmp(src.data(), dst.data(), batch * block_size * sizeof(std::uint64_t)) == 0);
+        a.read(dst.data(), block_size, 0);
+        REQUIRE(dst.data()[0] == 2 * block_size);
+    }
+}
+
+TEST_CASE("throughput benchmark runs on lock-based solutions")
+{
+    using solution = shared_solution<std::uint64_t, 16>;
+    const benchmark_results results = run_throughput_benchmark<solution, std::uint64_t, 16>(4, 16, 3, std::chrono::milliseconds(50));
+    REQUIRE(results.lost == std::vector<std::size_t>{0, 0, 0});
+    REQUIRE(results.metrics[3].first == "delivered_gb_per_s");
+    REQUIRE(results.metrics[3].second > 0.0);
+}
@@ -0,0 +1,37 @@
+#include <catch2/catch_test_macros.hpp>
+#include <timer.hpp>
+#include <thread>
+
+TEST_CASE("benchmark_timer is correctly implemented")
+{
+    const clock_calibration &c = clock_ticks::calibration();
+    REQUIRE(c.ns_per_tick > 0.0);
+
+    SECTION("intervals are measured in ns net of the timer overhead")
+    {
+        benchmark_timer timer;
+        const std::uint64_t t0 = timer.start();
+        const std::uint64_t t1 = timer.stop();
+        REQUIRE(timer.elapsed_ns(t0, t0) == 0);
+        REQUIRE(timer.elapsed_ns(t0, t1) < 1000000);
+
+        const std::uint64_t t2 = timer.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const std::uint64_t ns = timer.elapsed_ns(t2, timer.stop());
+        REQUIRE(ns >= 15000000);
+        REQUIRE(ns < 2000000000);
+    }
+
+    SECTION("sampled mode times one operation in N")
+    {
+        benchmark_timer timer(4);
+        REQUIRE(timer.sample_every() == 4);
+        std::size_t sampled{0};
+        for (int k = 0; k < 100; ++k)
+        {
+            sampled += timer.sample() ? 1 : 0;
+        }
+        REQUIRE(sampled == 25);
+        REQUIRE(benchmark_timer(0).sample_every() == 1);
+    }
+}
@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+#include <topology.hpp>
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+/// Two packages, each one L3 domain with two cores of two hardware threads. CPU numbering
+/// follows Linux: the second hardware thread of every core comes after all the first ones
+static cpu_topology two_sockets()
+{
+    return cpu_topology({{0, 0, 0, 0}, {1, 1, 0, 0}, {2, 0, 1, 2}, {3, 1, 1, 2},
+                         {4, 0, 0, 0}, {5, 1, 0, 0}, {6, 0, 1, 2}, {7, 1, 1, 2}});
+}
+
+TEST_CASE("threads are placed according to the topology")
+{
+    const cpu_topology t = two_sockets();
+    REQUIRE(t.size() == 8);
+    REQUIRE(t.l3_domains() == 2);
+
+    SECTION("no placement leaves every thread unpinned")
+    {
+        REQUIRE(t.assign(placement::none, 3) == std::vector<int>{-1, -1, -1});
+    }
+
+    SECTION("smt siblings share a core first")
+    {
+        REQUIRE(t.assign(placement::smt_siblings, 4) == std::vector<int>{0, 4, 1, 5});
+    }
+
+    SECTION("compact uses the cores of the first domain, then their siblings")
+    {
+        REQUIRE(t.assign(placement::compact, 3) == std::vector<int>{0, 1, 2});
+        REQUIRE(t.assign(placement::compact, 5) == std::vector<int>{0, 1, 2, 3, 4});
+    }
+
+    SECTION("scatter alternates between domains")
+    {
+        REQUIRE(t.assign(placement::scatter, 4) == std::vector<int>{0, 2, 1, 3});
+    }
+
+    SECTION("cross-l3 keeps the readers out of the writer's domain")
+    {
+        const std::vector<int> cpus = t.assign(placement::cross_l3, 4);
+        REQUIRE(cpus == std::vector<int>{0, 2, 3, 6});
+    }
+
+    SECTION("placements wrap around when there are more threads than CPUs")
+    {
+        const std::vector<int> cpus = t.assign(placement::compact, 10);
+        REQUIRE(cpus[8] == cpus[0]);
+        REQUIRE(std::set<int>(cpus.begin(), cpus.end()).size() == 8);
+    }
+
+    SECTION("placements are named on the command line")
+    {
+        REQUIRE(to_placement("smt-siblings") == placement::smt_siblings);
+        REQUIRE(to_string(to_placement("cross-l3")) == "cross-l3");
+        REQUIRE_THROWS_AS(to_placement("everywhere"), std::runtime_error);
+    }
+}
+
+TEST_CASE("the system topology can pin a thread")
+{
+    const cpu_topology &t = cpu_topology::system();
+    REQUIRE(t.size() > 0);
+    const std::vector<int> cpus = t.assign(placement::compact, 1);
+
+    std::atomic<bool> pinned{false};
+    std::thread worker([&pinned]
+                       { pinned.wait(false); });
+    REQUIRE(pin_thread(worker, -1));
+#if defined(__linux__)
+    REQUIRE(pin_thread(worker, cpus[0]));
+#endif
+    pinned = true;
+    pinned.notify_one();
+    worker.join();
+}
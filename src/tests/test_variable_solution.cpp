@@ -0,0 +1,134 @@
+#include <catch2/catch_test_macros.hpp>
+#include <aligned_array.hpp>
+#include <variable_solution.hpp>
+#include <variable_benchmark.hpp>
+
+TEST_CASE("variable_solution is correctly implemented")
+{
+    constexpr std::size_t num_blocks = 4;
+    constexpr std::size_t max_size = 40;
+    constexpr std::size_t alignment = 64;
+    variable_solution<std::uint16_t, alignment> a(num_blocks, max_size);
+    aligned_array<std::uint16_t> src(max_size);
+    aligned_array<std::uint16_t> dst(max_size);
+    frame_cursor consumer;
+
+    SECTION("write and read_next catch wrong input")
+    {
+        REQUIRE_THROWS_AS(a.write(nullptr, 1), std::runtime_error);
+        REQUIRE_THROWS_AS(a.write(src.data(), 0), std::runtime_error);
+        REQUIRE_THROWS_AS(a.write(src.data(), max_size + 1), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read_next(nullptr, max_size, consumer), std::runtime_error);
+        REQUIRE_THROWS_AS(a.read_next(dst.data(), max_size - 1, consumer), std::runtime_error);
+    }
+
+    SECTION("frames keep their length and content across wrap-arounds")
+    {
+        for (std::size_t k = 0; k < 50; ++k)
+        {
+            const std::size_t size = 1 + (7 * k) % max_size;
+            for (std::size_t j = 0; j < size; ++j)
+            {
+                src.data()[j] = static_cast<std::uint16_t>(k + j);
+            }
+            a.write(src.data(), size);
+
+            const frame_result r = a.read_next(dst.data(), dst.size(), consumer);
+            REQUIRE(r.status == read_status::ok);
+            REQUIRE(r.lost == 0);
+            REQUIRE(r.size == size);
+            REQUIRE(std::memcmp(src.data(), dst.data(), size * sizeof(std::uint16_t)) == 0);
+            REQUIRE(a.read_next(dst.data(), dst.size(), consumer).status == read_status::not_ready);
+        }
+    }
+
+    SECTION("overwritten frames are reported as lost")
+    {
+        constexpr std::size_t written = 20;
+        for (std::size_t k = 0; k < written; ++k)
+        {
+            fill_array(src, static_cast<std::uint16_t>(k));
+            a.write(src.data(), max_size);
+        }
+        frame_result r = a.read_next(dst.data(), dst.size(), consumer);
+        REQUIRE(r.status == read_status::ok);
+        REQUIRE(r.lost > 0);
+        REQUIRE(dst.data()[0] == r.lost);
+        std::size_t received = 1;
+        while (a.read_next(dst.data(), dst.size(), consumer).status == read_status::ok)
+        {
+            ++received;
+        }
+        REQUIRE(received + consumer.lost == written);
+        REQUIRE(dst.data()[0] == written - 1);
+    }
+}
+
+TEST_CASE("a ring of two maximum frames survives mixed frame sizes")
+{
+    constexpr std::size_t max_size = 16;
+    variable_solution<std::uint64_t, 16> a(2, max_size);
+    aligned_array<std::uint64_t> src(max_size);
+    aligned_array<std::uint64_t> dst(max_size);
+    frame_cursor consumer;
+
+    SECTION("a long frame that covers its own wrap marker keeps the ring readable")
+    {
+        for (std::uint64_t k = 0; k < 4; ++k)
+        {
+            fill_array(src, k);
+            a.write(src.data(), 2);
+        }
+        fill_array(src, std::uint64_t{4});
+        a.write(src.data(), max_size);
+        const frame_result r = a.read_next(dst.data(), dst.size(), consumer);
+        REQUIRE(r.status == read_status::ok);
+        REQUIRE(r.lost == 4);
+        REQUIRE(r.size == max_size);
+        REQUIRE(dst.data()[0] == 4);
+    }
+
+    SECTION("a reader that keeps up loses nothing")
+    {
+        for (std::uint64_t k = 0; k < 2000; ++k)
+        {
+            const std::size_t size = k % 3 == 2 ? max_size : 2;
+            fill_array(src, k);
+            a.write(src.data(), size);
+            const frame_result r = a.read_next(dst.data(), dst.size(), consumer);
+            REQUIRE(r.status == read_status::ok);
+            REQUIRE(r.lost == 0);
+            REQUIRE(r.size == size);
+            REQUIRE(dst.data()[0] == k);
+        }
+    }
+}
+
+TEST_CASE("frame_distribution stays within its range")
+{
+    for (const auto kind : {frame_distribution::shape::fixed,
+                            frame_distribution::shape::uniform,
+                            frame_distribution::shape::normal,
+                            frame_distribution::shape::exponential})
+    {
+        const frame_distribution frames{kind, 8, 64};
+        for (const auto size : frames.generate(1000))
+        {
+            REQUIRE(size >= frames.min_size);
+            REQUIRE(size <= frames.max_size);
+        }
+    }
+}
+
+TEST_CASE("variable benchmark samples its latencies")
+{
+    constexpr std::size_t cycles = 2000;
+    constexpr std::size_t sample_every = 4;
+    const frame_distribution frames{frame_distribution::shape::uniform, 8, 64};
+    const benchmark_results results = run_variable_benchmark<std::uint64_t, 16>(16, frames, 2, cycles, sample_every);
+    REQUIRE(results.times.size() == 3);
+    REQUIRE(results.write_latency.count() > 0);
+    REQUIRE(results.write_latency.count() <= (cycles - 1) / sample_every + 1);
+    REQUIRE(results.read_latency.count() > 0);
+    REQUIRE(results.read_latency.count() + results.lost[0] + results.lost[1] <= 2 * cycles);
+}
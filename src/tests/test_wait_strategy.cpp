@@ -0,0 +1,62 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_template_test_macros.hpp>
+#include <aligned_array.hpp>
+#include <seqlock_solution.hpp>
+#include <wait_strategy.hpp>
+#include <wait_benchmark.hpp>
+#include <thread>
+
+TEMPLATE_TEST_CASE("consumers wait for the writer with any wait strategy", "", busy_spin, spin_yield<>, futex_park<>, futex_park<0>)
+{
+    constexpr std::size_t num_blocks = 4;
+    constexpr std::size_t block_size = 8;
+    seqlock_solution<std::uint64_t, 64, memcpy_copy, TestType> a(num_blocks, block_size);
+    aligned_array<std::uint64_t, 64> src(block_size);
+    aligned_array<std::uint64_t, 64> dst(block_size);
+
+    SECTION("wait returns at once when the block is already published")
+    {
+        a.write(src.data(), block_size);
+        a.wait(0);
+        REQUIRE(a.head() == 1);
+    }
+
+    SECTION("a waiting consumer is released by every publication")
+    {
+        constexpr std::size_t cycles = 200;
+        consumer_cursor consumer;
+        std::size_t received{0};
+        std::thread reader([&]
+                           {
+            while (consumer.next < cycles)
+            {
+                a.wait(consumer.next);
+                if (a.read_next(dst.data(), block_size, consumer).status == read_status::ok)
+                {
+                    ++received;
+                }
+            } });
+        for (std::uint64_t k = 0; k < cycles; ++k)
+        {
+            fill_array(src, k);
+            a.write(src.data(), block_size);
+            if (k % 16 == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+        reader.join();
+        REQUIRE(consumer.next == cycles);
+        REQUIRE(received + consumer.lost == cycles);
+    }
+}
+
+TEST_CASE("wait benchmark reports latency and CPU usage")
+{
+    using solution = seqlock_solution<std::uint64_t, 16, memcpy_copy, futex_park<>>;
+    const benchmark_results results = run_wait_benchmark<solution, std::uint64_t, 16>(4, 16, 2, 500, 20000);
+    REQUIRE(results.times.size() == 3);
+    REQUIRE(results.lost.size() == 2);
+    REQUIRE(results.metrics.size() == 2);
+    REQUIRE(results.metrics[0].first == "reader_cpu_percent");
+}
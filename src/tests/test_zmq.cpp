@@ -1,4 +1,5 @@
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
 #include <zmq.hpp>
 
 #include <future>
@@ -8,6 +9,7 @@
 
 #include "zmq.hpp"
 #include "zmq_addon.hpp"
+#include <zmq_benchmark.hpp>
 
 void PublisherThread(zmq::context_t *ctx)
 {
@@ -86,3 +88,57 @@ TEST_CASE("zmq sends and receives messages")
     thread2.join();
     thread3.join();
 }
+
+TEST_CASE("zmq transports are parsed by name")
+{
+    REQUIRE(to_zmq_transport("inproc") == zmq_transport::inproc);
+    REQUIRE(to_zmq_transport("ipc") == zmq_transport::ipc);
+    REQUIRE(to_zmq_transport("tcp") == zmq_transport::tcp);
+    REQUIRE_THROWS_AS(to_zmq_transport("udp"), std::runtime_error);
+}
+
+TEST_CASE("zmq benchmark delivers every block without copies")
+{
+    constexpr std::size_t num_blocks = 10;
+    constexpr std::size_t block_size = 64;
+    constexpr std::size_t readers = 2;
+    constexpr std::size_t cycles = 5000;
+
+    for (const auto transport : {zmq_transport::inproc, zmq_transport::tcp})
+    {
+        const zmq_options options{transport, 1000, false};
+        const benchmark_results results = run_zmq_benchmark<std::uint64_t, 16>(num_blocks, block_size, readers, cycles, 1, placement::none, options);
+        // the pool holds fewer blocks than the high water mark, so inproc never drops one
+        if (transport == zmq_transport::inproc)
+        {
+            REQUIRE(results.lost == std::vector<std::size_t>(readers, 0));
+            REQUIRE(results.read_latency.count() == readers * (cycles - 1));
+        }
+        REQUIRE(results.write_latency.count() == cycles - 1);
+    }
+
+    SECTION("a single block pool is widened to two")
+    {
+        REQUIRE_THROWS_AS((zmq_block_pool<std::uint64_t, 16>(1, block_size)), std::runtime_error);
+        const zmq_options options{zmq_transport::inproc, 1000, false};
+        const benchmark_results results = run_zmq_benchmark<std::uint64_t, 16>(1, block_size, readers, cycles, 1, placement::none, options);
+        REQUIRE(results.lost == std::vector<std::size_t>(readers, 0));
+        REQUIRE(results.read_latency.count() == readers * (cycles - 1));
+    }
+
+    SECTION("conflating subscribers still see the last block")
+    {
+        const zmq_options options{zmq_transport::inproc, 1000, true};
+        const benchmark_results results = run_zmq_benchmark<std::uint64_t, 16>(num_blocks, block_size, readers, cycles, 1, placement::none, options);
+        REQUIRE(results.lost.size() == readers);
+        REQUIRE(results.read_latency.count() + results.lost[0] + results.lost[1] == readers * (cycles - 1));
+        for (std::size_t k = 0; k < readers; ++k)
+        {
+            const std::string name = "reader_" + std::to_string(k) + "_last_block";
+            const auto metric = std::find_if(results.metrics.begin(), results.metrics.end(), [&](const auto &m)
+                                             { return m.first == name; });
+            REQUIRE(metric != results.metrics.end());
+            REQUIRE(metric->second == static_cast<double>(cycles - 2));
+        }
+    }
+}
@@ -77,6 +77,33 @@ def plot_performance(baseline, seqlock, shared_mutex, mutex, zmq=None,
     plt.savefig(read_filename, dpi=dpi)
 
 
+def plot_percentiles(datasets, key="read_latency",
+                     filename="plots/read_percentiles.png",
+                     dpi=300):
+    """Median line with p50-p99 and p99-p99.9 bands and the maximum, one colour per implementation.
+    `datasets` maps a label to the matched results, `key` selects write_latency or read_latency"""
+    colours = ["k", "r", "g", "b", "m", "c", "y"]
+    plt.figure(f"{key} percentiles")
+    for (label, dataset), colour in zip(datasets.items(), colours):
+        dataset = [x for x in dataset if key in x]
+        if len(dataset) == 0:
+            continue
+        block_size = [int(x["block_size"]) for x in dataset]
+        p50 = [x[key]["p50"] for x in dataset]
+        p99 = [x[key]["p99"] for x in dataset]
+        p999 = [x[key]["p99.9"] for x in dataset]
+        maximum = [x[key]["max"] for x in dataset]
+        plt.fill_between(block_size, p50, p99, color=colour, alpha=0.3, linewidth=0)
+        plt.fill_between(block_size, p99, p999, color=colour, alpha=0.1, linewidth=0)
+        plt.semilogy(block_size, p50, f"{colour}.-", label=f"{label} p50, p99, p99.9")
+        plt.semilogy(block_size, maximum, f"{colour}:", linewidth=0.8)
+
+    plt.xlabel("block size, double precision samples")
+    plt.ylabel("time per operation, ns")
+    plt.legend(frameon=False)
+    plt.savefig(filename, dpi=dpi)
+
+
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description="Plot benchmark results")
     parser.add_argument("data",
@@ -85,6 +112,10 @@ if __name__ == "__main__":
     parser.add_argument("--zmq",
                         help="(optional) include ZeroMQ results. Disabled by default",
                         action="store_true")
+    parser.add_argument("--zmq-transport",
+                        help="ZeroMQ transport to plot with --zmq: inproc, ipc or tcp. Default inproc",
+                        choices=["inproc", "ipc", "tcp"],
+                        default="inproc")
     args = parser.parse_args()
 
     with open(args.data, "r") as fp:
@@ -97,10 +128,17 @@ if __name__ == "__main__":
     shared_mutex_dataset = match(results, implementation="Shared mutex", num_readers=num_readers)
     mutex_dataset = match(results, implementation="Mutex", num_readers=num_readers)
     if args.zmq:
-        zmq_dataset = match(results, implementation="ZMQ", num_readers=num_readers)
+        zmq_dataset = match(results, implementation=f"ZMQ {args.zmq_transport}", num_readers=num_readers)
     else:
         zmq_dataset = None
 
     plot_performance(baseline_dataset, seqlock_dataset, shared_mutex_dataset, mutex_dataset, zmq_dataset)
 
+    percentile_datasets = {"Baseline": baseline_dataset,
+                           "SeqLock": seqlock_dataset,
+                           "Shared mutex": shared_mutex_dataset,
+                           "Mutex": mutex_dataset}
+    plot_percentiles(percentile_datasets, key="write_latency", filename="plots/write_percentiles.png")
+    plot_percentiles(percentile_datasets, key="read_latency", filename="plots/read_percentiles.png")
+
     plt.show()
\ No newline at end of file